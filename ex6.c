@@ -1,11 +1,10 @@
 #include "ex6.h"
 #include <ctype.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-# define INT_BUFFER 128
-
 // ================================================
 // Basic struct definitions from ex6.h assumed:
 //   PokemonData { int id; char *name; PokemonType TYPE; int hp; int attack; EvolutionStatus CAN_EVOLVE; }
@@ -19,29 +18,6 @@
 // 1) Safe integer reading
 // --------------------------------------------------------------
 
-void trimWhitespace(char *str)
-{
-    // Remove leading spaces/tabs/\r
-    int start = 0;
-    while (str[start] == ' ' || str[start] == '\t' || str[start] == '\r')
-        start++;
-
-    if (start > 0)
-    {
-        int idx = 0;
-        while (str[start])
-            str[idx++] = str[start++];
-        str[idx] = '\0';
-    }
-
-    // Remove trailing spaces/tabs/\r
-    int len = (int)strlen(str);
-    while (len > 0 && (str[len - 1] == ' ' || str[len - 1] == '\t' || str[len - 1] == '\r'))
-    {
-        str[--len] = '\0';
-    }
-}
-
 char *myStrdup(const char *src)
 {
     if (!src)
@@ -59,7 +35,6 @@ char *myStrdup(const char *src)
 
 int readIntSafe(const char *prompt)
 {
-    char buffer[INT_BUFFER];
     int value;
     int success = 0;
 
@@ -67,24 +42,11 @@ int readIntSafe(const char *prompt)
     {
         printf("%s", prompt);
 
-        // If we fail to read, treat it as invalid
-        if (!fgets(buffer, sizeof(buffer), stdin))
-        {
-            printf("Invalid input.\n");
-            clearerr(stdin);
-            continue;
-        }
-
-        // 1) Strip any trailing \r or \n
-        //    so "123\r\n" becomes "123"
-        size_t len = strlen(buffer);
-        if (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r'))
-            buffer[--len] = '\0';
-        if (len > 0 && (buffer[len - 1] == '\r' || buffer[len - 1] == '\n'))
-            buffer[--len] = '\0';
+        // 1) Get the line, already stripped of \r, \n and surrounding spaces
+        char *line = readInputLine();
 
         // 2) Check if empty after stripping
-        if (len == 0)
+        if (*line == '\0')
         {
             printf("Invalid input.\n");
             continue;
@@ -92,7 +54,7 @@ int readIntSafe(const char *prompt)
 
         // 3) Attempt to parse integer with strtol
         char *endptr;
-        value = (int)strtol(buffer, &endptr, 10);
+        value = (int)strtol(line, &endptr, 10);
 
         // If endptr didn't point to the end => leftover chars => invalid
         // or if buffer was something non-numeric
@@ -110,84 +72,194 @@ int readIntSafe(const char *prompt)
 }
 
 // --------------------------------------------------------------
-// 2) Utility: Get type name from enum
+// Utility: buffered display output
 // --------------------------------------------------------------
-const char *getTypeName(PokemonType type)
+void outFlush()
 {
-    switch (type)
+    //anything printf'd before the buffered rows has to reach the fd first
+    fflush(stdout);
+
+    int written = 0;
+    while (written < outputBuffer.used)
     {
-    case GRASS:
-        return "GRASS";
-    case FIRE:
-        return "FIRE";
-    case WATER:
-        return "WATER";
-    case BUG:
-        return "BUG";
-    case NORMAL:
-        return "NORMAL";
-    case POISON:
-        return "POISON";
-    case ELECTRIC:
-        return "ELECTRIC";
-    case GROUND:
-        return "GROUND";
-    case FAIRY:
-        return "FAIRY";
-    case FIGHTING:
-        return "FIGHTING";
-    case PSYCHIC:
-        return "PSYCHIC";
-    case ROCK:
-        return "ROCK";
-    case GHOST:
-        return "GHOST";
-    case DRAGON:
-        return "DRAGON";
-    case ICE:
-        return "ICE";
-    default:
-        return "UNKNOWN";
+        ssize_t n = write(STDOUT_FILENO, outputBuffer.data + written, outputBuffer.used - written);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            break;
+        }
+        written += (int)n;
     }
+    outputBuffer.used = 0;
 }
 
-// --------------------------------------------------------------
-// Utility: getDynamicInput (for reading a line into malloc'd memory)
-// --------------------------------------------------------------
-char *getDynamicInput()
+void outWrite(const char *text, int length)
 {
-    char *input = NULL;
-    size_t size = 0, capacity = 1;
-    input = (char *)malloc(capacity);
-    if (!input)
+    while (length > 0)
     {
-        printf("Memory allocation failed.\n");
-        return NULL;
+        if (outputBuffer.used == OUTPUT_BUFFER_SIZE)
+            outFlush();
+        int chunk = OUTPUT_BUFFER_SIZE - outputBuffer.used;
+        if (chunk > length)
+            chunk = length;
+        memcpy(outputBuffer.data + outputBuffer.used, text, chunk);
+        outputBuffer.used += chunk;
+        text += chunk;
+        length -= chunk;
+    }
+}
+
+void outString(const char *text)
+{
+    outWrite(text, (int)strlen(text));
+}
+
+void outInt(int value)
+{
+    char digits[12];
+    int pos = sizeof(digits);
+    //work on the magnitude as unsigned so INT_MIN doesn't overflow
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+    do
+    {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        digits[--pos] = '-';
+    outWrite(digits + pos, (int)sizeof(digits) - pos);
+}
+
+void outFraction(long numerator, long denominator)
+{
+    //rounded to the nearest 1/10000
+    long long scaled = ((long long)numerator * 20000 / denominator + 1) / 2;
+    outInt((int)(scaled / 10000));
+    char digits[5] = {'.', '0', '0', '0', '0'};
+    long fraction = scaled % 10000;
+    for (int i = 4; i >= 1; i--)
+    {
+        digits[i] = (char)('0' + fraction % 10);
+        fraction /= 10;
     }
+    outWrite(digits, 5);
+}
+
+void outCents(long cents)
+{
+    //cents / 100 with exactly 2 digits after the point, like printf's %.2f
+    outInt((int)(cents / 100));
+    char digits[3] = {'.', (char)('0' + cents % 100 / 10), (char)('0' + cents % 10)};
+    outWrite(digits, 3);
+}
+
+// --------------------------------------------------------------
+// Utility: block-buffered input
+// --------------------------------------------------------------
+char *nextInputLine(InputReader *reader)
+{
+    size_t scanned = reader->start;
+    size_t lineEnd;
+    size_t next;
 
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF)
+    while (1)
     {
-        if (size + 1 >= capacity)
+        // 1) A whole line is already buffered
+        char *newline = (reader->end > scanned)
+                            ? memchr(reader->data + scanned, '\n', reader->end - scanned)
+                            : NULL;
+        if (newline != NULL)
         {
-            capacity *= 2;
-            char *temp = (char *)realloc(input, capacity);
-            if (!temp)
-            {
-                printf("Memory reallocation failed.\n");
-                free(input);
+            lineEnd = (size_t)(newline - reader->data);
+            next = lineEnd + 1;
+            break;
+        }
+        scanned = reader->end;
+
+        // 2) End of input: hand out the unterminated last line, if any
+        if (reader->eof)
+        {
+            if (reader->start == reader->end)
                 return NULL;
+            lineEnd = reader->end;
+            next = reader->end;
+            break;
+        }
+
+        // 3) Move the partial line to the front, grow if it fills the buffer
+        //    (one byte stays free for the NUL of an unterminated last line)
+        if (reader->start > 0)
+        {
+            memmove(reader->data, reader->data + reader->start, reader->end - reader->start);
+            reader->end -= reader->start;
+            scanned -= reader->start;
+            reader->start = 0;
+        }
+        if (reader->end + 1 >= reader->capacity)
+        {
+            size_t capacity = reader->capacity == 0 ? INPUT_BUFFER_SIZE : reader->capacity * 2;
+            char *data = (char *)realloc(reader->data, capacity);
+            if (!data)
+            {
+                printf("Memory allocation failed.\n");
+                exit(1);
             }
-            input = temp;
+            reader->data = data;
+            reader->capacity = capacity;
         }
-        input[size++] = (char)c;
+
+        // 4) Read the next block - a prompt waiting in stdout has to be seen first, and
+        //    everything done with the input so far is made durable before waiting for more
+        fflush(stdout);
+        journalFlush();
+        ssize_t got = read(reader->fd, reader->data + reader->end, reader->capacity - reader->end - 1);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            reader->eof = 1;
+        else
+            reader->end += (size_t)got;
     }
-    input[size] = '\0';
 
-    // Trim any leading/trailing whitespace or carriage returns
-    trimWhitespace(input);
+    // 5) Trim the view in place(spaces, tabs and the \r of CRLF) and terminate it
+    char *line = reader->data + reader->start;
+    char *last = reader->data + lineEnd;
+    reader->start = next;
+    while (line < last && (*line == ' ' || *line == '\t' || *line == '\r'))
+        line++;
+    while (last > line && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r'))
+        last--;
+    *last = '\0';
+    return line;
+}
+
+char *readInputLine()
+{
+    char *line = nextInputLine(&stdinReader);
+    if (line == NULL)
+        endOfInput();
+    return line;
+}
+
+void releaseInputReader(InputReader *reader)
+{
+    free(reader->data);
+    reader->data = NULL;
+    reader->capacity = 0;
+    reader->start = 0;
+    reader->end = 0;
+}
 
-    return input;
+void endOfInput()
+{
+    printf("\n");
+    freeAllOwners();
+    releaseScratchNodes();
+    releaseInputReader(&stdinReader);
+    unmapRegistryImage();
+    closeJournal();
+    exit(0);
 }
 
 // Function to print a single Pokemon node
@@ -195,30 +267,44 @@ void printPokemonNode(PokemonNode *node)
 {
     if (!node)
         return;
-    printf("ID: %d, Name: %s, Type: %s, HP: %d, Attack: %d, Can Evolve: %s\n",
-           node->data->id,
-           node->data->name,
-           getTypeName(node->data->TYPE),
-           node->data->hp,
-           node->data->attack,
-           (node->data->CAN_EVOLVE == CAN_EVOLVE) ? "Yes" : "No");
+    printSpeciesRow(node->data);
+}
+
+// Function to print a single species row
+void printSpeciesRow(const PokemonData *data)
+{
+    const TypeName *type = &typeNames[data->TYPE];
+    outWrite("ID: ", 4);
+    outInt(data->id);
+    outWrite(", Name: ", 8);
+    outString(data->name);
+    outWrite(", Type: ", 8);
+    outWrite(type->name, type->length);
+    outWrite(", HP: ", 6);
+    outInt(data->hp);
+    outWrite(", Attack: ", 10);
+    outInt(data->attack);
+    if (data->CAN_EVOLVE == CAN_EVOLVE)
+        outWrite(", Can Evolve: Yes\n", 18);
+    else
+        outWrite(", Can Evolve: No\n", 17);
 }
 
 // Function to add a given owner to the existing list of owners
 void linkOwnerInCircularList(OwnerNode *owner) {
+    ownerIndexInsert(owner);
+    registryAppend(owner);
+
     // 1) if there are no owners - make the head point to the new owner
     if(ownerHead == NULL) {
         ownerHead = owner;
         return;
     }
 
+    // 2) the node which points to head is head's prev (or head itself while it's alone)
     OwnerNode* temp = ownerHead;
-
-    // 2) if the list contains more than the head node - search for the node which points to head
     if(ownerHead->next != NULL) {
-        while(temp->next != ownerHead) {
-            temp = temp->next;
-        }
+        temp = ownerHead->prev;
     }
 
     // 3) set its next pointer to owner and vice versa
@@ -230,43 +316,216 @@ void linkOwnerInCircularList(OwnerNode *owner) {
     owner->next = ownerHead;
 }
 
-//Function to create new Pokemon data matching the Pokemon we want to create
-PokemonData *createPokemonData(const PokemonData pokedexEntry) {
-    // 1) allocate data for the data
-    PokemonData* newPokemon = (PokemonData *)malloc(sizeof(PokemonData));
-    if(newPokemon == NULL) {
-        printf("Memory allocation failed.\n");
-        exit(1);
+// Function to init an arena which doesn't own any memory yet
+void initPokemonArena(PokemonArena *arena) {
+    arena->chunks = NULL;
+    arena->lastChunk = NULL;
+    arena->freeList = NULL;
+    arena->nextChunkSize = ARENA_FIRST_CHUNK;
+}
+
+// Function to hand out one slot from an arena
+PokemonNode *allocPokemonSlot(PokemonArena *arena) {
+    // 1) reuse a released slot if there is one
+    if(arena->freeList != NULL) {
+        PokemonNode* reused = arena->freeList;
+        arena->freeList = reused->left;
+        return reused;
     }
 
-    // 2) copy the Pokedex entry details into the new Pokemon's data we've created
-    newPokemon->id = pokedexEntry.id;
-    newPokemon->name = myStrdup(pokedexEntry.name);
-    newPokemon->TYPE = pokedexEntry.TYPE;
-    newPokemon->hp = pokedexEntry.hp;
-    newPokemon->attack = pokedexEntry.attack;
-    newPokemon->CAN_EVOLVE = pokedexEntry.CAN_EVOLVE;
+    // 2) if the newest chunk is full (or there is none) - allocate a bigger one
+    if(arena->chunks == NULL || arena->chunks->used == arena->chunks->capacity) {
+        int capacity = arena->nextChunkSize;
+        ArenaChunk* chunk = (ArenaChunk *)malloc(sizeof(ArenaChunk) + capacity * sizeof(PokemonNode));
+        if(chunk == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        if(arena->chunks == NULL) {
+            arena->lastChunk = chunk;
+        }
+        arena->chunks = chunk;
+        if(arena->nextChunkSize < ARENA_MAX_CHUNK) {
+            arena->nextChunkSize *= 2;
+        }
+    }
 
-    return newPokemon;
+    // 3) take the next unused slot of the newest chunk
+    return &arena->chunks->slots[arena->chunks->used++];
 }
 
-// Function to create a new Pokemon node based on the given Pokemon's data
-PokemonNode *createPokemonNode(PokemonData *data) {
-    // 1) allocate new memory
-    PokemonNode* newPokemon = (PokemonNode*)malloc(sizeof(PokemonNode));
-    if (newPokemon == NULL) {
-        printf("Memory allocation failed.\n");
-        exit(1);
+// Function to push a slot back onto its arena's free list
+void releasePokemonSlot(PokemonArena *arena, PokemonNode *node) {
+    node->left = arena->freeList;
+    node->right = NULL;
+    arena->freeList = node;
+}
+
+// Function to move all memory of one arena into another
+void adoptPokemonArena(PokemonArena *dest, PokemonArena *src) {
+    // 1) append the source chunks after the destination's oldest chunk
+    if(src->chunks != NULL) {
+        if(dest->chunks == NULL) {
+            dest->chunks = src->chunks;
+        }
+        else {
+            dest->lastChunk->next = src->chunks;
+        }
+        dest->lastChunk = src->lastChunk;
+    }
+
+    // 2) append the destination's free list after the source's one
+    if(src->freeList != NULL) {
+        PokemonNode* tail = src->freeList;
+        while(tail->left != NULL) {
+            tail = tail->left;
+        }
+        tail->left = dest->freeList;
+        dest->freeList = src->freeList;
+    }
+
+    initPokemonArena(src);
+}
+
+// Function to free all chunks of an arena - every node in it is gone afterwards
+void releasePokemonArena(PokemonArena *arena) {
+    ArenaChunk* chunk = arena->chunks;
+    while(chunk != NULL) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
     }
+    initPokemonArena(arena);
+}
+
+// Function to get the shared(read-only) species record of a given Pokemon ID
+const PokemonData *getSpeciesData(int id) {
+    return &pokedex[id - 1];
+}
+
+// Function to create a new Pokemon node for the given Pokemon ID
+PokemonNode *createPokemonNode(PokemonArena *arena, int id) {
+    // 1) take a slot from the owner's arena
+    PokemonNode* newPokemon = allocPokemonSlot(arena);
 
-    // 2) init data
-    newPokemon->data = data;
+    // 2) init data - the node only points at the species record, nothing is copied
+    newPokemon->data = getSpeciesData(id);
     newPokemon->left = NULL;
     newPokemon->right = NULL;
+    newPokemon->height = 1;
+    newPokemon->size = 1;
+    newPokemon->heapSlot = -1;
 
     return newPokemon;
 }
 
+// Function to get the height of a given subtree(0 for an empty one)
+int getNodeHeight(PokemonNode *node) {
+    if(node == NULL) {
+        return 0;
+    }
+    return node->height;
+}
+
+// Function to get the number of nodes in a given subtree(0 for an empty one)
+int getNodeSize(PokemonNode *node) {
+    if(node == NULL) {
+        return 0;
+    }
+    return node->size;
+}
+
+// Function to recompute the height and subtree size of a node from its children
+void updateNodeHeightAndSize(PokemonNode *node) {
+    int leftHeight = getNodeHeight(node->left);
+    int rightHeight = getNodeHeight(node->right);
+    node->height = 1 + (leftHeight > rightHeight ? leftHeight : rightHeight);
+    node->size = 1 + getNodeSize(node->left) + getNodeSize(node->right);
+}
+
+// Function to get storage for an explicit traversal stack: the caller's buffer if it's deep enough
+void *allocTreeStack(void *inlineBuffer, int depth, size_t elementSize) {
+    if(depth <= TREE_STACK_INLINE) {
+        return inlineBuffer;
+    }
+    void* stack = malloc(depth * elementSize);
+    if(stack == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    return stack;
+}
+
+// Function to release a traversal stack from allocTreeStack
+void freeTreeStack(void *stack, void *inlineBuffer) {
+    if(stack != inlineBuffer) {
+        free(stack);
+    }
+}
+
+// Function to rebalance every node on a root-to-leaf path of links, deepest first
+void rebalancePath(PokemonNode ***path, int depth) {
+    for(int i = depth - 1; i >= 0; i--) {
+        *path[i] = rebalancePokemonNode(*path[i]);
+    }
+}
+
+// Function to rotate a subtree left - the right child becomes the new root
+PokemonNode *rotateLeft(PokemonNode *root) {
+    PokemonNode* newRoot = root->right;
+    root->right = newRoot->left;
+    newRoot->left = root;
+
+    //the old root is now below the new one, so update it first
+    updateNodeHeightAndSize(root);
+    updateNodeHeightAndSize(newRoot);
+    return newRoot;
+}
+
+// Function to rotate a subtree right - the left child becomes the new root
+PokemonNode *rotateRight(PokemonNode *root) {
+    PokemonNode* newRoot = root->left;
+    root->left = newRoot->right;
+    newRoot->right = root;
+
+    //the old root is now below the new one, so update it first
+    updateNodeHeightAndSize(root);
+    updateNodeHeightAndSize(newRoot);
+    return newRoot;
+}
+
+// Function to fix a node's height and restore the AVL balance below it if needed
+PokemonNode *rebalancePokemonNode(PokemonNode *root) {
+    if(root == NULL) {
+        return root;
+    }
+    updateNodeHeightAndSize(root);
+
+#if POKEDEX_BALANCED
+    int balance = getNodeHeight(root->left) - getNodeHeight(root->right);
+
+    // 1) left side is too tall - rotate right (left-right case rotates the child first)
+    if(balance > 1) {
+        if(getNodeHeight(root->left->left) < getNodeHeight(root->left->right)) {
+            root->left = rotateLeft(root->left);
+        }
+        return rotateRight(root);
+    }
+    // 2) right side is too tall - rotate left (right-left case rotates the child first)
+    if(balance < -1) {
+        if(getNodeHeight(root->right->right) < getNodeHeight(root->right->left)) {
+            root->right = rotateRight(root->right);
+        }
+        return rotateLeft(root);
+    }
+#endif
+
+    return root;
+}
+
 // Function to insert a given PokemonNode to the Owner's Pokedex tree
 PokemonNode *insertPokemonNode(PokemonNode *root, PokemonNode *newNode) {
     // 1) If the Pokedex is empty make the root the new Pokemon's node
@@ -275,38 +534,116 @@ PokemonNode *insertPokemonNode(PokemonNode *root, PokemonNode *newNode) {
         return root;
     }
 
-    // 2) Check for the right placement for the Pokemon to be put in(by ID)
-    if(newNode->data->id < root->data->id) {
-        root->left = insertPokemonNode(root->left, newNode);
-    }
-    if(newNode->data->id > root->data->id) {
-       root->right = insertPokemonNode(root->right, newNode);
+    // 2) Walk down to the right placement(by ID), remembering every link on the way
+    PokemonNode** inlinePath[TREE_STACK_INLINE];
+    PokemonNode*** path = (PokemonNode ***)allocTreeStack(inlinePath, root->height, sizeof(PokemonNode **));
+    int depth = 0;
+    PokemonNode** link = &root;
+    while(*link != NULL) {
+        //duplicates are left out
+        if(newNode->data->id == (*link)->data->id) {
+            freeTreeStack(path, inlinePath);
+            return root;
+        }
+        path[depth++] = link;
+        link = (newNode->data->id < (*link)->data->id) ? &(*link)->left : &(*link)->right;
     }
+    *link = newNode;
 
+    // 3) Fix the heights on the way back up and rotate where a subtree got unbalanced
+    rebalancePath(path, depth);
+    freeTreeStack(path, inlinePath);
     return root;
 }
 
 // Function to search for a Pokemon in a given owner's Pokedex.
 PokemonNode *searchPokemonBFS(PokemonNode *root, int id) {
-    // 1) If the pokemon wasn't found - return NULL
-    if(root == NULL) {
-        return root;
+    //compare the node ID values with the given ID and progress accordingly until found(or NULL)
+    while(root != NULL && root->data->id != id) {
+        root = (id < root->data->id) ? root->left : root->right;
     }
+    return root;
+}
 
-    // 2) if the root's ID matches - return its node
-    if(root->data->id == id) {
-        return root;
+// Function to test an owner's Pokedex bitset for a given ID
+int ownerHasPokemon(const OwnerNode *owner, int id) {
+    if(id < 1 || id > POKEDEX_SIZE) {
+        return 0;
     }
+    return (int)((owner->pokedexBits[(id - 1) / 64] >> ((id - 1) % 64)) & 1);
+}
+
+// Function to count the Pokemon in an owner's Pokedex
+int countOwnedPokemon(const OwnerNode *owner) {
+    return owner->stats.pokemonCount;
+}
 
-    // 3) Compare the left/right node ID values with the given ID and progress accordingly
-    if(id < root->data->id) {
-        return searchPokemonBFS(root->left, id);
+// Function to set/clear the bit of a given ID in an owner's Pokedex bitset
+void setPokemonOwned(OwnerNode *owner, int id, int owned) {
+    uint64_t mask = (uint64_t)1 << ((id - 1) % 64);
+    uint64_t* word = &owner->pokedexBits[(id - 1) / 64];
+    //the aggregates only move when the bit actually flips
+    if(owned && !(*word & mask)) {
+        *word |= mask;
+        statsAddSpecies(&owner->stats, id);
     }
-    if(id > root->data->id) {
-        return searchPokemonBFS(root->right, id);
+    else if(!owned && (*word & mask)) {
+        *word &= ~mask;
+        statsRemoveSpecies(&owner->stats, id);
     }
+}
 
-    return root;
+// Function to add a species to an owner's aggregates
+void statsAddSpecies(OwnerStats *stats, int id) {
+    const PokemonData* data = &pokedex[id - 1];
+    int rank = speciesScoreRank[id - 1];
+    stats->pokemonCount++;
+    stats->typeCounts[data->TYPE]++;
+    stats->totalHp += data->hp;
+    stats->totalAttack += data->attack;
+    stats->evolvableCount += (data->CAN_EVOLVE == CAN_EVOLVE);
+    stats->scoreRankBits[rank / 64] |= (uint64_t)1 << (rank % 64);
+}
+
+// Function to remove a species from an owner's aggregates
+void statsRemoveSpecies(OwnerStats *stats, int id) {
+    const PokemonData* data = &pokedex[id - 1];
+    int rank = speciesScoreRank[id - 1];
+    stats->pokemonCount--;
+    stats->typeCounts[data->TYPE]--;
+    stats->totalHp -= data->hp;
+    stats->totalAttack -= data->attack;
+    stats->evolvableCount -= (data->CAN_EVOLVE == CAN_EVOLVE);
+    stats->scoreRankBits[rank / 64] &= ~((uint64_t)1 << (rank % 64));
+}
+
+// Function to get the best fight score of an owner(the lowest score rank it has)
+float statsMaxScore(const OwnerStats *stats) {
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        if(stats->scoreRankBits[w] != 0) {
+            return speciesScore[speciesByScoreRank[w * 64 + lowestSetBit(stats->scoreRankBits[w])] - 1];
+        }
+    }
+    return 0;
+}
+
+// Function to get the index of the lowest set bit of a non-zero word(de Bruijn multiplication)
+int lowestSetBit(uint64_t word) {
+    static const unsigned char deBruijnIndex[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+    };
+    return deBruijnIndex[((word & (0 - word)) * 0x03F79D71B4CB0A89ULL) >> 58];
+}
+
+// Function to build the per-type species bitsets once
+void initTypeMasks() {
+    memset(typeSpeciesBits, 0, sizeof(typeSpeciesBits));
+    for(int id = 1; id <= POKEDEX_SIZE; id++) {
+        typeSpeciesBits[pokedex[id - 1].TYPE][(id - 1) / 64] |= (uint64_t)1 << ((id - 1) % 64);
+    }
 }
 
 // --------------------------------------------------------------
@@ -316,25 +653,38 @@ void addPokemon(OwnerNode *owner) {
     // 1) Get the pokemon's ID from the user
     int pokemonId = readIntSafe("Enter ID to add: ");
 
-    // 2) Validate the ID (if it's in range of 1-151 - Pokedex entries)
-    if(pokemonId < 1 || pokemonId > 151) {
-        printf("Invalid ID.\n");
-        return;
+    // 2) Add it and report what happened
+    switch(addPokemonCore(owner, pokemonId)) {
+        case OP_INVALID_ID:
+            printf("Invalid ID.\n");
+            break;
+        case OP_ALREADY_OWNED:
+            printf("Pokemon with ID %d is already in the Pokedex. No changes made.\n", pokemonId);
+            break;
+        default:
+            printf("Pokemon %s (ID %d) added.\n", pokedex[pokemonId - 1].name, pokemonId);
     }
+}
 
-    // 2) Check if the pokemon already exists in the pokedex
-    if(searchPokemonBFS(owner->pokedexRoot, pokemonId) != NULL) {
-        printf("Pokemon with ID %d is already in the Pokedex. No changes made.\n", pokemonId);
-        return;
+// Function to add a Pokemon to an owner's Pokedex without printing anything
+OpStatus addPokemonCore(OwnerNode *owner, int id) {
+    // 1) Validate the ID (if it's in range of 1-151 - Pokedex entries)
+    if(id < 1 || id > POKEDEX_SIZE) {
+        return OP_INVALID_ID;
     }
 
-    // 4) create the new Pokemon node to be entered
-    PokemonData* newPokemonData = createPokemonData(pokedex[pokemonId - 1]);
-    PokemonNode* newPokemonNode = createPokemonNode(newPokemonData);
+    // 2) Check if the pokemon already exists in the pokedex
+    if(ownerHasPokemon(owner, id)) {
+        return OP_ALREADY_OWNED;
+    }
 
-    //3) If it doesn't - insert it to the pokedex
+    // 3) create the new Pokemon node and insert it
+    PokemonNode* newPokemonNode = createPokemonNode(&owner->arena, id);
+    leaderboardInsert(owner, newPokemonNode);
     owner->pokedexRoot = insertPokemonNode(owner->pokedexRoot, newPokemonNode);
-    printf("Pokemon %s (ID %d) added.\n", newPokemonData->name, newPokemonData->id);
+    setPokemonOwned(owner, id, 1);
+    journalOwnerOp(JOURNAL_ADD, owner, 0, (uint32_t)id);
+    return OP_OK;
 }
 
 // Function to create a new owner and add it to the linked-list of owners
@@ -349,6 +699,13 @@ OwnerNode *createOwner(char *ownerName, PokemonNode *starter) {
     // 2) copy properties into the owner
     newOwner->ownerName = ownerName;
     newOwner->pokedexRoot = starter;
+    initPokemonArena(&newOwner->arena);
+    memset(newOwner->pokedexBits, 0, sizeof(newOwner->pokedexBits));
+    memset(&newOwner->stats, 0, sizeof(newOwner->stats));
+    newOwner->journalId = -1;
+    if(starter != NULL) {
+        setPokemonOwned(newOwner, starter->data->id, 1);
+    }
     newOwner->next = NULL;
     newOwner->prev = NULL;
 
@@ -361,55 +718,74 @@ OwnerNode *createOwner(char *ownerName, PokemonNode *starter) {
 void openPokedexMenu() {
     // 1) get the name and starter choice form the user
     printf("Your name: ");
-    char* trainerName = getDynamicInput();
-    if(findOwnerByName(trainerName) != NULL) {
-        printf("Owner '%s' already exists. Not creating a new Pokedex.\n", trainerName);
-        free(trainerName);
+    char* name = readInputLine();
+    if(findOwnerByName(name) != NULL) {
+        printf("Owner '%s' already exists. Not creating a new Pokedex.\n", name);
         return;
     }
+    //the view only lasts until the next read - copy it now, it becomes the owner's name
+    char* trainerName = myStrdup(name);
     int starterChoice = readIntSafe("Choose Starter:\n"
                  "1. Bulbasaur\n"
                  "2. Charmander\n"
                  "3. Squirtle\n"
                  "Your choice: ");
 
-    PokemonData* data = NULL;
+    // 2) create and link the owner
+    if(openPokedexCore(trainerName, starterChoice) != OP_OK) {
+        //invalid choice case: free trainerName and go back to main menu
+        printf("Invalid choice.\n");
+        free(trainerName);
+        return;
+    }
+
+    printf("New Pokedex created for %s with starter %s.\n", trainerName,
+                  findOwnerByName(trainerName)->pokedexRoot->data->name);
+}
+
+// Function to create an owner with a starter and link it into the list without printing anything
+OpStatus openPokedexCore(char *ownerName, int starterChoice) {
+    if(ownerNameTaken(ownerName)) {
+        return OP_NAME_TAKEN;
+    }
+
+    int starterId = 0;
 
-    // 2) set the new Pokemon Data according to the starter that was picked
+    // 1) pick the pokedex entry according to the starter that was picked
     switch(starterChoice) {
-        //set data to Bulbasaur's data
+        //Bulbasaur's entry
         case 1: {
-            data = createPokemonData(pokedex[0]);
+            starterId = 1;
             break;
         }
-        //set data to Charmander's data
+        //Charmander's entry
         case 2: {
-            data = createPokemonData(pokedex[3]);
+            starterId = 4;
             break;
         }
-        //set data to Squirtle's data
+        //Squirtle's entry
         case 3: {
-            data = createPokemonData(pokedex[6]);
+            starterId = 7;
             break;
         }
-        //invalid choice case: free trainerName and go back to main menu
         default: {
-            printf("Invalid choice.\n");
-            free(trainerName);
-            return;
+            return OP_INVALID_CHOICE;
         }
     }
 
-    // 3) create the starter's Pokemon Node based on the data we made
-    PokemonNode* starter = createPokemonNode(data);
+    // 2) create the new owner
+    OwnerNode* newOwner = createOwner(ownerName, NULL);
 
-    // 4) create the new owner
-    OwnerNode* newOwner = createOwner(trainerName, starter);
+    // 3) create the starter's Pokemon Node inside the owner's arena
+    PokemonNode* starter = createPokemonNode(&newOwner->arena, starterId);
+    newOwner->pokedexRoot = starter;
+    setPokemonOwned(newOwner, starterId, 1);
+    leaderboardInsert(newOwner, starter);
 
-    // 5) add the owner to the list of owners
+    // 4) add the owner to the list of owners
     linkOwnerInCircularList(newOwner);
-
-    printf("New Pokedex created for %s with starter %s.\n", trainerName, starter->data->name);
+    journalNewOwner(newOwner, starterChoice);
+    return OP_OK;
 }
 
 // Function to print all owners once in a numbered menu
@@ -419,9 +795,12 @@ void printAllOwners() {
         return;
     }
 
-    printf("1. %s\n", ownerHead->ownerName);
+    outWrite("1. ", 3);
+    outString(ownerHead->ownerName);
+    outWrite("\n", 1);
     // 2) If the list is comprised only of one node print it and return
     if(ownerHead->next == NULL) {
+        outFlush();
         return;
     }
 
@@ -430,10 +809,14 @@ void printAllOwners() {
 
     // 3) print all owners in a menu list
     while(printNode != ownerHead) {
-        printf("%d. %s\n", i, printNode->ownerName);
+        outInt(i);
+        outWrite(". ", 2);
+        outString(printNode->ownerName);
+        outWrite("\n", 1);
         i++;
         printNode = printNode->next;
     }
+    outFlush();
 }
 
 // Function to find the owner by order number starting from head
@@ -443,136 +826,632 @@ OwnerNode *findOwnerByPosition(int orderPosition) {
         return ownerHead;
     }
 
-    OwnerNode* searchNode = ownerHead;
-
-    // 2) keep going until the number of movements needed is met
-    while(orderPosition > 0 && searchNode->next != NULL) {
-        searchNode = searchNode->next;
-        orderPosition--;
+    // 2) walking the ring wraps around, so only the remainder of the steps matters
+    if(orderPosition <= 0 || ownerHead->next == NULL) {
+        return ownerHead;
     }
-
-    return searchNode;
-}
-
-// --------------------------------------------------------------
-// Display Menu
-// --------------------------------------------------------------
-void displayMenu(OwnerNode *owner)
-{
-    if (!owner->pokedexRoot)
-    {
-        printf("Pokedex is empty.\n");
-        return;
+    int target = orderPosition % ownerRegistry.alive;
+
+    // 3) Fenwick descent: find the slot holding the (target + 1)-th alive owner
+    int slot = 0;
+    int remaining = target + 1;
+    int step = 1;
+    while(step * 2 <= ownerRegistry.capacity) {
+        step *= 2;
+    }
+    for(; step > 0; step /= 2) {
+        if(slot + step <= ownerRegistry.capacity && ownerRegistry.fenwick[slot + step] < remaining) {
+            slot += step;
+            remaining -= ownerRegistry.fenwick[slot];
+        }
     }
 
-    printf("Display:\n");
-    printf("1. BFS (Level-Order)\n");
-    printf("2. Pre-Order\n");
-    printf("3. In-Order\n");
-    printf("4. Post-Order\n");
-    printf("5. Alphabetical (by name)\n");
-
-    int choice = readIntSafe("Your choice: ");
+    return ownerRegistry.slots[slot];
+}
 
-    switch (choice)
-    {
-    case 1:
-        displayBFS(owner->pokedexRoot);
-        break;
-    case 2:
-        preOrderTraversal(owner->pokedexRoot);
-        break;
-    case 3:
-        inOrderTraversal(owner->pokedexRoot);
-        break;
-    case 4:
-        postOrderTraversal(owner->pokedexRoot);
-        break;
-    case 5:
-        displayAlphabetical(owner->pokedexRoot);
-        break;
-    default:
-        printf("Invalid choice.\n");
+// Function to add a value to one slot of the registry's Fenwick tree
+void registryFenwickAdd(int slot, int delta) {
+    for(int i = slot + 1; i <= ownerRegistry.capacity; i += i & (-i)) {
+        ownerRegistry.fenwick[i] += delta;
     }
 }
 
-// Function to add a Pokemon node to a given queue
-void enqueue(Queue* queue, PokemonNode *node) {
-    QueueNode* newNode = (QueueNode *)malloc(sizeof(QueueNode));
-    if (newNode == NULL) {
+// Function to rebuild the registry from the ring (in ring order, without removed slots)
+void registryRebuild(int capacity) {
+    // 1) allocate the new arrays
+    OwnerNode** slots = (OwnerNode **)malloc(capacity * sizeof(OwnerNode *));
+    int* fenwick = (int *)calloc(capacity + 1, sizeof(int));
+    if(slots == NULL || fenwick == NULL) {
         printf("Memory allocation failed.\n");
         exit(1);
     }
 
-    //point the QueueNode's PokemonNode to the given node we wish to enqueue
-    newNode->treeNode = node;
-    newNode->next = NULL;
-
-    //if the queue is empty - make both first and last nodes the single node we enqueue
-    if(queue->rear == NULL) {
-        queue->rear = newNode;
-        queue->front = newNode;
-    }
-    //otherwise, make the new node the next element of the queue
-    else {
-        queue->rear->next = newNode;
-        queue->rear = newNode;
+    // 2) walk the ring from head - this also picks up a reordered (sorted) ring
+    int used = 0;
+    OwnerNode* current = ownerHead;
+    while(current != NULL) {
+        current->registrySlot = used;
+        slots[used] = current;
+        fenwick[used + 1] = 1;
+        used++;
+        current = current->next;
+        if(current == ownerHead) {
+            break;
+        }
     }
-}
 
-// Function to pop the first-out PokemonNode of a given queue an return it
-PokemonNode *dequeue(Queue* queue) {
-    if(queue->front == NULL) {
-        return NULL;
+    // 3) linear-time Fenwick construction: push each node's count into its parent
+    for(int i = 1; i <= capacity; i++) {
+        int parent = i + (i & (-i));
+        if(parent <= capacity) {
+            fenwick[parent] += fenwick[i];
+        }
     }
 
-    //store the last QueueNode and its PokemonNode
-    QueueNode* temp = queue->front;
-    PokemonNode* treeTemp = temp->treeNode;
-    //advance the queue forward
-    queue->front = queue->front->next;
+    free(ownerRegistry.slots);
+    free(ownerRegistry.fenwick);
+    ownerRegistry.slots = slots;
+    ownerRegistry.fenwick = fenwick;
+    ownerRegistry.capacity = capacity;
+    ownerRegistry.used = used;
+    ownerRegistry.alive = used;
+}
 
-    //if the queue has been emptied - make both rear and front NULL
-    if(queue->front == NULL) {
-        queue->rear = NULL;
+// Function to append an owner to the registry
+void registryAppend(OwnerNode *owner) {
+    // 1) out of slots - compact if at least half of them were removed, grow otherwise
+    if(ownerRegistry.used == ownerRegistry.capacity) {
+        int capacity = ownerRegistry.capacity;
+        if(capacity == 0) {
+            capacity = OWNER_REGISTRY_MIN_CAPACITY;
+        }
+        else if(ownerRegistry.alive * 2 > capacity) {
+            capacity *= 2;
+        }
+        registryRebuild(capacity);
     }
 
-    free(temp);
-    return treeTemp;
+    // 2) take the next slot (the owner isn't in the ring yet, so the rebuild didn't see it)
+    owner->registrySlot = ownerRegistry.used;
+    ownerRegistry.slots[ownerRegistry.used++] = owner;
+    ownerRegistry.alive++;
+    registryFenwickAdd(owner->registrySlot, 1);
 }
 
-// Function to display all Pokemon using BFS method
-void displayBFS(PokemonNode *root) {
-    VisitNodeFunc nodePrintPtr = printPokemonNode;
+// Function to mark an owner's registry slot as removed
+void registryRemove(OwnerNode *owner) {
+    ownerRegistry.slots[owner->registrySlot] = NULL;
+    registryFenwickAdd(owner->registrySlot, -1);
+    ownerRegistry.alive--;
+}
 
-    //create a queue to handle the order of Pokemon tree nodes
-    Queue* bfsQueue = malloc(sizeof(Queue));
-    if(bfsQueue == NULL) {
+// Function to free the registry
+void registryClear() {
+    free(ownerRegistry.slots);
+    free(ownerRegistry.fenwick);
+    ownerRegistry.slots = NULL;
+    ownerRegistry.fenwick = NULL;
+    ownerRegistry.capacity = 0;
+    ownerRegistry.used = 0;
+    ownerRegistry.alive = 0;
+}
+
+// --------------------------------------------------------------
+// Global Leaderboard
+// --------------------------------------------------------------
+
+// Function to compute the fight score of every species once
+void initSpeciesScores() {
+    for(int id = 1; id <= POKEDEX_SIZE; id++) {
+        speciesScore[id - 1] = fightScore(&pokedex[id - 1]);
+    }
+
+    //rank them best first(ties by lower ID) - insertion sort, it's 151 entries once
+    for(int i = 0; i < POKEDEX_SIZE; i++) {
+        int id = i + 1;
+        int slot = i;
+        while(slot > 0) {
+            int other = speciesByScoreRank[slot - 1];
+            if(speciesScore[other - 1] > speciesScore[id - 1] ||
+               (speciesScore[other - 1] == speciesScore[id - 1] && other < id)) {
+                break;
+            }
+            speciesByScoreRank[slot] = other;
+            slot--;
+        }
+        speciesByScoreRank[slot] = id;
+    }
+    for(int rank = 0; rank < POKEDEX_SIZE; rank++) {
+        speciesScoreRank[speciesByScoreRank[rank] - 1] = rank;
+    }
+}
+
+// Function to tell if an entry belongs above another one in the heap
+int leaderboardAbove(const LeaderboardEntry *a, const LeaderboardEntry *b) {
+    if(a->score != b->score) {
+        return a->score > b->score;
+    }
+    return a->node->data->id < b->node->data->id;
+}
+
+// Function to restore the heap order around one slot(it moves either up or down, never both)
+void leaderboardSift(int slot) {
+    LeaderboardEntry* entries = leaderboard.entries;
+    LeaderboardEntry moving = entries[slot];
+
+    // 1) up: pull parents down while the entry beats them
+    while(slot > 0 && leaderboardAbove(&moving, &entries[(slot - 1) / 2])) {
+        entries[slot] = entries[(slot - 1) / 2];
+        entries[slot].node->heapSlot = slot;
+        slot = (slot - 1) / 2;
+    }
+    entries[slot] = moving;
+    moving.node->heapSlot = slot;
+
+    // 2) down, if it didn't move up
+    leaderboardSiftDown(slot);
+}
+
+// Function to move a leaderboard entry down to its place
+void leaderboardSiftDown(int slot) {
+    LeaderboardEntry* entries = leaderboard.entries;
+    LeaderboardEntry moving = entries[slot];
+
+    //pull the better child up while it beats the entry
+    while(2 * slot + 1 < leaderboard.count) {
+        int child = 2 * slot + 1;
+        if(child + 1 < leaderboard.count && leaderboardAbove(&entries[child + 1], &entries[child])) {
+            child++;
+        }
+        if(!leaderboardAbove(&entries[child], &moving)) {
+            break;
+        }
+        entries[slot] = entries[child];
+        entries[slot].node->heapSlot = slot;
+        slot = child;
+    }
+    entries[slot] = moving;
+    moving.node->heapSlot = slot;
+}
+
+// Function to add a Pokemon of an owner to the leaderboard
+void leaderboardInsert(OwnerNode *owner, PokemonNode *node) {
+    leaderboardAppend(owner, node);
+    leaderboardSift(leaderboard.count - 1);
+}
+
+// Function to add a leaderboard entry at the end, leaving the heap order to the caller
+void leaderboardAppend(OwnerNode *owner, PokemonNode *node) {
+    //grow by doubling
+    if(leaderboard.count == leaderboard.capacity) {
+        int newCapacity = leaderboard.capacity > 0 ? leaderboard.capacity * 2 : 64;
+        LeaderboardEntry* temp = realloc(leaderboard.entries, newCapacity * sizeof(LeaderboardEntry));
+        if(temp == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        leaderboard.entries = temp;
+        leaderboard.capacity = newCapacity;
+    }
+
+    int slot = leaderboard.count++;
+    leaderboard.entries[slot].score = speciesScore[node->data->id - 1];
+    leaderboard.entries[slot].node = node;
+    leaderboard.entries[slot].owner = owner;
+    node->heapSlot = slot;
+}
+
+// Function to restore the heap order of the whole leaderboard(Floyd's bottom-up build)
+void leaderboardHeapify() {
+    for(int slot = leaderboard.count / 2 - 1; slot >= 0; slot--) {
+        leaderboardSiftDown(slot);
+    }
+}
+
+// Function to take a Pokemon out of the leaderboard
+void leaderboardRemove(PokemonNode *node) {
+    int slot = node->heapSlot;
+    //not in it(e.g. the leaderboard was already cleared at exit)
+    if(slot < 0 || slot >= leaderboard.count || leaderboard.entries[slot].node != node) {
+        return;
+    }
+    node->heapSlot = -1;
+
+    //the last entry fills the hole and is sifted into place
+    leaderboard.count--;
+    if(slot == leaderboard.count) {
+        return;
+    }
+    leaderboard.entries[slot] = leaderboard.entries[leaderboard.count];
+    leaderboardSift(slot);
+}
+
+// Function to re-score a Pokemon after its species changed
+void leaderboardUpdate(PokemonNode *node) {
+    int slot = node->heapSlot;
+    if(slot < 0 || slot >= leaderboard.count || leaderboard.entries[slot].node != node) {
+        return;
+    }
+    leaderboard.entries[slot].score = speciesScore[node->data->id - 1];
+    leaderboardSift(slot);
+}
+
+// Function to change the owner recorded for a Pokemon
+void leaderboardSetOwner(PokemonNode *node, OwnerNode *owner) {
+    int slot = node->heapSlot;
+    if(slot < 0 || slot >= leaderboard.count || leaderboard.entries[slot].node != node) {
+        return;
+    }
+    leaderboard.entries[slot].owner = owner;
+}
+
+// Function to free the leaderboard
+void leaderboardClear() {
+    free(leaderboard.entries);
+    leaderboard.entries = NULL;
+    leaderboard.capacity = 0;
+    leaderboard.count = 0;
+}
+
+// Function to add a leaderboard index to a candidate heap(ordered like the leaderboard)
+void candidateHeapPush(int *heap, int *count, int value) {
+    int slot = (*count)++;
+    while(slot > 0 && leaderboardAbove(&leaderboard.entries[value], &leaderboard.entries[heap[(slot - 1) / 2]])) {
+        heap[slot] = heap[(slot - 1) / 2];
+        slot = (slot - 1) / 2;
+    }
+    heap[slot] = value;
+}
+
+// Function to take the best leaderboard index out of a candidate heap
+int candidateHeapPop(int *heap, int *count) {
+    int best = heap[0];
+    int value = heap[--(*count)];
+    int slot = 0;
+    while(2 * slot + 1 < *count) {
+        int child = 2 * slot + 1;
+        if(child + 1 < *count && leaderboardAbove(&leaderboard.entries[heap[child + 1]], &leaderboard.entries[heap[child]])) {
+            child++;
+        }
+        if(!leaderboardAbove(&leaderboard.entries[heap[child]], &leaderboard.entries[value])) {
+            break;
+        }
+        heap[slot] = heap[child];
+        slot = child;
+    }
+    if(*count > 0) {
+        heap[slot] = value;
+    }
+    return best;
+}
+
+// Function to find the indexes of the k best leaderboard entries, best first
+int leaderboardTopK(int k, int *result) {
+    if(k > leaderboard.count) {
+        k = leaderboard.count;
+    }
+    if(k <= 0) {
+        return 0;
+    }
+
+    //candidates: a small max-heap of leaderboard indexes(at most k + 1 of them at once).
+    //Only the top of the big heap is ever looked at
+    int inlineCandidates[LEADERBOARD_STACK_K + 1];
+    int* candidates = inlineCandidates;
+    if(k > LEADERBOARD_STACK_K) {
+        candidates = malloc((size_t)(k + 1) * sizeof(int));
+        if(candidates == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+    }
+    int candidateCount = 0;
+    candidateHeapPush(candidates, &candidateCount, 0);
+
+    for(int found = 0; found < k; found++) {
+        //the best candidate is the next best entry, and its children become candidates
+        int best = candidateHeapPop(candidates, &candidateCount);
+        result[found] = best;
+        if(2 * best + 1 < leaderboard.count) {
+            candidateHeapPush(candidates, &candidateCount, 2 * best + 1);
+        }
+        if(2 * best + 2 < leaderboard.count) {
+            candidateHeapPush(candidates, &candidateCount, 2 * best + 2);
+        }
+    }
+
+    if(candidates != inlineCandidates) {
+        free(candidates);
+    }
+    return k;
+}
+
+// Function to print the strongest Pokemon of all owners
+void displayTopPokemon() {
+    if(leaderboard.count == 0) {
+        printf("No Pokemon to rank.\n");
+        return;
+    }
+    int k = readIntSafe("How many? ");
+    if(k < 1) {
+        printf("Invalid number.\n");
+        return;
+    }
+    printTopPokemon(k);
+}
+
+// Function to print the k strongest Pokemon of all owners
+void printTopPokemon(int k) {
+    if(k > leaderboard.count) {
+        k = leaderboard.count;
+    }
+    if(k < 1) {
+        return;
+    }
+
+    int* top = malloc((size_t)k * sizeof(int));
+    if(top == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    int found = leaderboardTopK(k, top);
+    for(int i = 0; i < found; i++) {
+        const LeaderboardEntry* entry = &leaderboard.entries[top[i]];
+        outWrite("#", 1);
+        outInt(i + 1);
+        outWrite(" [", 2);
+        outString(entry->owner->ownerName);
+        outWrite("] ", 2);
+        outString(entry->node->data->name);
+        outWrite(" (ID ", 5);
+        outInt(entry->node->data->id);
+        outWrite("), Score: ", 10);
+        outCents((long)(entry->score * 100 + 0.5f));
+        outWrite("\n", 1);
+    }
+    outFlush();
+    free(top);
+}
+
+// Function to get the value of one leaderboard key from an owner's aggregates
+double ownerStatValue(const OwnerStats *stats, OwnerStatKey key) {
+    switch(key) {
+        case OWNER_KEY_COUNT:
+            return stats->pokemonCount;
+        case OWNER_KEY_TOTAL_HP:
+            return stats->totalHp;
+        case OWNER_KEY_AVERAGE_HP:
+            return stats->pokemonCount > 0 ? (double)stats->totalHp / stats->pokemonCount : 0;
+        case OWNER_KEY_TOTAL_ATTACK:
+            return stats->totalAttack;
+        case OWNER_KEY_AVERAGE_ATTACK:
+            return stats->pokemonCount > 0 ? (double)stats->totalAttack / stats->pokemonCount : 0;
+        case OWNER_KEY_MAX_SCORE:
+            return statsMaxScore(stats);
+        case OWNER_KEY_EVOLVABLE:
+            return stats->evolvableCount;
+    }
+    return 0;
+}
+
+// Function to compare two owner leaderboard rows(higher key first, then by name)
+int compareOwnerRank(const void *a, const void *b) {
+    const OwnerRankEntry* first = (const OwnerRankEntry*)a;
+    const OwnerRankEntry* second = (const OwnerRankEntry*)b;
+    if(first->key != second->key) {
+        return first->key > second->key ? -1 : 1;
+    }
+    return strcmp(first->owner->ownerName, second->owner->ownerName);
+}
+
+// Function to print every owner's aggregates, sorted by a key the user picks
+void displayOwnerLeaderboard() {
+    if(ownerHead == NULL) {
+        printf("No owners.\n");
+        return;
+    }
+
+    printf("Sort owners by:\n");
+    printf("1. Pokemon count\n");
+    printf("2. Total HP\n");
+    printf("3. Average HP\n");
+    printf("4. Total attack\n");
+    printf("5. Average attack\n");
+    printf("6. Best fight score\n");
+    printf("7. Evolvable count\n");
+    int choice = readIntSafe("Your choice: ");
+    if(choice < 1 || choice > OWNER_KEY_TOTAL) {
+        printf("Invalid choice.\n");
+        return;
+    }
+    OwnerStatKey key = (OwnerStatKey)(choice - 1);
+
+    // 1) one row per owner, the key read straight from the cached aggregates
+    int count = ownerRegistry.alive;
+    OwnerRankEntry* rows = malloc((size_t)count * sizeof(OwnerRankEntry));
+    if(rows == NULL) {
         printf("Memory allocation failed.\n");
         exit(1);
     }
-    bfsQueue->front = NULL;
-    bfsQueue->rear = NULL;
+    OwnerNode* owner = ownerHead;
+    for(int i = 0; i < count; i++) {
+        rows[i].key = ownerStatValue(&owner->stats, key);
+        rows[i].owner = owner;
+        owner = owner->next;
+    }
+    qsort(rows, count, sizeof(OwnerRankEntry), compareOwnerRank);
+
+    // 2) print them
+    for(int i = 0; i < count; i++) {
+        const OwnerStats* stats = &rows[i].owner->stats;
+        int pokemon = stats->pokemonCount > 0 ? stats->pokemonCount : 1;
+        outWrite("#", 1);
+        outInt(i + 1);
+        outWrite(" ", 1);
+        outString(rows[i].owner->ownerName);
+        outWrite(": Pokemon ", 10);
+        outInt(stats->pokemonCount);
+        outWrite(", HP ", 5);
+        outInt(stats->totalHp);
+        outWrite(" (avg ", 6);
+        outFraction(stats->totalHp, pokemon);
+        outWrite("), Attack ", 10);
+        outInt(stats->totalAttack);
+        outWrite(" (avg ", 6);
+        outFraction(stats->totalAttack, pokemon);
+        outWrite("), Best Score ", 14);
+        outCents((long)(statsMaxScore(stats) * 100 + 0.5f));
+        outWrite(", Evolvable ", 12);
+        outInt(stats->evolvableCount);
+        outWrite("\n", 1);
+    }
+    outFlush();
+    free(rows);
+}
+
+// --------------------------------------------------------------
+// Display Menu
+// --------------------------------------------------------------
+void displayMenu(OwnerNode *owner)
+{
+    if (!owner->pokedexRoot)
+    {
+        printf("Pokedex is empty.\n");
+        return;
+    }
+
+    printf("Display:\n");
+    printf("1. BFS (Level-Order)\n");
+    printf("2. Pre-Order\n");
+    printf("3. In-Order\n");
+    printf("4. Post-Order\n");
+    printf("5. Alphabetical (by name)\n");
+    printf("6. ID Range\n");
+
+    int choice = readIntSafe("Your choice: ");
+
+    switch (choice)
+    {
+    case 1:
+        displayBFS(owner->pokedexRoot);
+        break;
+    case 2:
+        preOrderTraversal(owner->pokedexRoot);
+        break;
+    case 3:
+        inOrderTraversal(owner->pokedexRoot);
+        break;
+    case 4:
+        postOrderTraversal(owner->pokedexRoot);
+        break;
+    case 5:
+        displayAlphabetical(owner->pokedexRoot);
+        break;
+    case 6:
+        displayRange(owner->pokedexRoot);
+        break;
+    default:
+        printf("Invalid choice.\n");
+    }
+    outFlush();
+}
+
+// Function to set up an empty queue on a given buffer
+void initQueue(Queue *queue, PokemonNode **buffer, int capacity) {
+    queue->items = buffer;
+    queue->capacity = capacity;
+    queue->front = 0;
+    queue->count = 0;
+    queue->ownsItems = 0;
+}
+
+// Function to free the queue's heap storage(if it ever grew)
+void freeQueue(Queue *queue) {
+    if(queue->ownsItems) {
+        free(queue->items);
+    }
+    queue->items = NULL;
+    queue->capacity = 0;
+    queue->count = 0;
+}
+
+// Function to add a Pokemon node to a given queue
+void enqueue(Queue* queue, PokemonNode *node) {
+    //if the ring is full - double it, unwrapping the elements to the start of the new buffer
+    if(queue->count == queue->capacity) {
+        int newCapacity = queue->capacity * 2;
+        PokemonNode** newItems = (PokemonNode **)malloc(newCapacity * sizeof(PokemonNode *));
+        if (newItems == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        for(int i = 0; i < queue->count; i++) {
+            newItems[i] = queue->items[(queue->front + i) & (queue->capacity - 1)];
+        }
+        if(queue->ownsItems) {
+            free(queue->items);
+        }
+        queue->items = newItems;
+        queue->capacity = newCapacity;
+        queue->front = 0;
+        queue->ownsItems = 1;
+    }
+
+    //the rear is 'count' places after the front, wrapping around the ring
+    queue->items[(queue->front + queue->count) & (queue->capacity - 1)] = node;
+    queue->count++;
+}
+
+// Function to pop the first-out PokemonNode of a given queue an return it
+PokemonNode *dequeue(Queue* queue) {
+    if(queue->count == 0) {
+        return NULL;
+    }
+
+    //take the front element and advance the front around the ring
+    PokemonNode* treeTemp = queue->items[queue->front];
+    queue->front = (queue->front + 1) & (queue->capacity - 1);
+    queue->count--;
+
+    return treeTemp;
+}
+
+// Function to visit all nodes of a tree level by level using a queue
+void BFSGeneric(PokemonNode *root, VisitNodeFunc visit) {
+    if(root == NULL) {
+        return;
+    }
+
+    //the queue lives on the stack until (if ever) the tree gets too wide for it
+    PokemonNode* stackBuffer[BFS_STACK_QUEUE];
+    Queue bfsQueue;
+    initQueue(&bfsQueue, stackBuffer, BFS_STACK_QUEUE);
 
     //enqueue the root node
-    enqueue(bfsQueue, root);
+    enqueue(&bfsQueue, root);
 
-    //go over the queue's nodes and print them as long as the queue still has nodes in it
-    while(bfsQueue->front != NULL) {
-        //take the first node to come out of the queue and print it
-        PokemonNode* current = dequeue(bfsQueue);
-        nodePrintPtr(current);
+    //go over the queue's nodes and visit them as long as the queue still has nodes in it
+    while(bfsQueue.count > 0) {
+        //take the first node to come out of the queue and visit it
+        PokemonNode* current = dequeue(&bfsQueue);
+        visit(current);
 
         //check both sides for child nodes and enqueue them
         if(current->left != NULL) {
-            enqueue(bfsQueue, current->left);
+            enqueue(&bfsQueue, current->left);
         }
         if(current->right != NULL) {
-            enqueue(bfsQueue, current->right);
+            enqueue(&bfsQueue, current->right);
         }
     }
 
-    free(bfsQueue);
+    freeQueue(&bfsQueue);
+}
+
+// Function to display all Pokemon using BFS method
+void displayBFS(PokemonNode *root) {
+    VisitNodeFunc nodePrintPtr = printPokemonNode;
+    BFSGeneric(root, nodePrintPtr);
 }
 
 // Function to traverse the tree in pre-order method
@@ -586,12 +1465,25 @@ void preOrderGeneric(PokemonNode *root, VisitNodeFunc visit) {
     if(root == NULL) {
         return;
     }
-    //print root first
-    visit(root);
-    //print left side second
-    preOrderGeneric(root->left, visit);
-    //print right side last
-    preOrderGeneric(root->right, visit);
+
+    //explicit stack - the right child is pushed first so the left side is visited first
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height + 1, sizeof(PokemonNode *));
+    int top = 0;
+    stack[top++] = root;
+    while(top > 0) {
+        //print root first
+        PokemonNode* current = stack[--top];
+        visit(current);
+        //left side second, right side last
+        if(current->right != NULL) {
+            stack[top++] = current->right;
+        }
+        if(current->left != NULL) {
+            stack[top++] = current->left;
+        }
+    }
+    freeTreeStack(stack, inlineStack);
 }
 
 // Function to traverse nodes by in-order method
@@ -605,12 +1497,68 @@ void inOrderGeneric(PokemonNode *root, VisitNodeFunc visit) {
     if(root == NULL) {
         return;
     }
-    //print left side first
-    inOrderGeneric(root->left, visit);
-    //print root second
-    visit(root);
-    //print right side last
-    inOrderGeneric(root->right, visit);
+
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height, sizeof(PokemonNode *));
+    int top = 0;
+    PokemonNode* current = root;
+    while(current != NULL || top > 0) {
+        //go as far left as possible first
+        while(current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        //print root second
+        current = stack[--top];
+        visit(current);
+        //right side last
+        current = current->right;
+    }
+    freeTreeStack(stack, inlineStack);
+}
+
+// Function to display the Pokemon in an ID range(prompted to user prior)
+void displayRange(PokemonNode *root) {
+    VisitNodeFunc nodePrintPtr = printPokemonNode;
+    int low = readIntSafe("Enter lowest ID: ");
+    int high = readIntSafe("Enter highest ID: ");
+    rangeGeneric(root, low, high, nodePrintPtr);
+}
+
+// Function to visit in-order only the nodes of a Pokedex tree with an ID in [low, high]
+void rangeGeneric(PokemonNode *root, int low, int high, VisitNodeFunc visit) {
+    if(root == NULL || low > high) {
+        return;
+    }
+
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height, sizeof(PokemonNode *));
+    int top = 0;
+    PokemonNode* current = root;
+    while(current != NULL || top > 0) {
+        //go left only while the left side can still hold IDs in range
+        while(current != NULL) {
+            if(current->data->id < low) {
+                //this node and its left subtree are all below the range
+                current = current->right;
+            }
+            else {
+                stack[top++] = current;
+                current = current->left;
+            }
+        }
+        if(top == 0) {
+            break;
+        }
+        current = stack[--top];
+        //everything left on the stack or to the right is larger - done
+        if(current->data->id > high) {
+            break;
+        }
+        visit(current);
+        current = current->right;
+    }
+    freeTreeStack(stack, inlineStack);
 }
 
 // Function to traverse nodes by post-order method
@@ -624,49 +1572,84 @@ void postOrderGeneric(PokemonNode *root, VisitNodeFunc visit) {
     if(root == NULL) {
         return;
     }
-    //print left side first
-    postOrderGeneric(root->left, visit);
-    //print right side second
-    postOrderGeneric(root->right, visit);
-    //print root last
-    visit(root);
+
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height, sizeof(PokemonNode *));
+    int top = 0;
+    PokemonNode* current = root;
+    PokemonNode* lastVisited = NULL;
+    while(current != NULL || top > 0) {
+        //left side first
+        while(current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        PokemonNode* peek = stack[top - 1];
+        //right side second, unless it was just finished
+        if(peek->right != NULL && peek->right != lastVisited) {
+            current = peek->right;
+        }
+        //print root last
+        else {
+            visit(peek);
+            lastVisited = peek;
+            top--;
+        }
+    }
+    freeTreeStack(stack, inlineStack);
 }
 
 // Function to alphabetically all nodes alphabetically
 void displayAlphabetical(PokemonNode *root) {
     VisitNodeFunc nodePrintPtr = printPokemonNode;
 
-    //init node array and copy all nodes into it
-    NodeArray* nodeArray = malloc(sizeof(NodeArray));
-    if(nodeArray == NULL) {
-        printf("Memory allocation error.\n");
-        exit(1);
-    }
-    initNodeArray(nodeArray, 1);
-    collectAll(root, nodeArray);
+    //one bucket per species, filled by name rank
+    PokemonNode* byRank[POKEDEX_SIZE];
+    memset(byRank, 0, sizeof(byRank));
+    scatterByNameRank(root, byRank);
 
-    //sort the array using a generic Pokemon node name comparison function
-    qsort(nodeArray->nodes, nodeArray->size, sizeof(PokemonNode*), compareByNameNode);
+    //print the buckets by their order
+    for(int rank = 0; rank < POKEDEX_SIZE; rank++) {
+        if(byRank[rank] != NULL) {
+            nodePrintPtr(byRank[rank]);
+        }
+    }
+}
 
-    //print the sorted array by its order
-    for(int i = 0; i < nodeArray->size; i++) {
-        nodePrintPtr(nodeArray->nodes[i]);
+// Function to place each node of a Pokedex tree in the bucket of its name rank
+void scatterByNameRank(PokemonNode *root, PokemonNode **byRank) {
+    if(root == NULL) {
+        return;
     }
 
-    //free the node array
-    free(nodeArray->nodes);
-    free(nodeArray);
+    //order of the walk doesn't matter - every node lands in its own bucket
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height + 1, sizeof(PokemonNode *));
+    int top = 0;
+    stack[top++] = root;
+    while(top > 0) {
+        PokemonNode* current = stack[--top];
+        byRank[speciesNameRank[current->data->id - 1]] = current;
+        if(current->right != NULL) {
+            stack[top++] = current->right;
+        }
+        if(current->left != NULL) {
+            stack[top++] = current->left;
+        }
+    }
+    freeTreeStack(stack, inlineStack);
 }
 
-// Function to init the node array with a given capacity
-void initNodeArray(NodeArray *na, int cap) {
-    na->capacity = cap;
-    na->nodes = malloc(cap * sizeof(PokemonNode*));
-    if(na->nodes == NULL) {
-        printf("Memory allocation error.\n");
-        exit(1);
+// Function to compute the alphabetical rank of every species once
+void initNameRanks() {
+    const PokemonData* species[POKEDEX_SIZE];
+    for(int i = 0; i < POKEDEX_SIZE; i++) {
+        species[i] = &pokedex[i];
+    }
+    qsort(species, POKEDEX_SIZE, sizeof(const PokemonData*), compareSpeciesByName);
+    for(int rank = 0; rank < POKEDEX_SIZE; rank++) {
+        speciesNameRank[species[rank]->id - 1] = rank;
     }
-    na->size = 0;
 }
 
 // Function to copy all given Pokedex tree nodes into a NodeArray
@@ -674,9 +1657,46 @@ void collectAll(PokemonNode *root, NodeArray *na) {
     if(root == NULL || na == NULL) {
         return;
     }
-    addNode(na, root);
-    collectAll(root->left, na);
-    collectAll(root->right, na);
+
+    //same pre-order walk as preOrderGeneric, adding instead of visiting
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height + 1, sizeof(PokemonNode *));
+    int top = 0;
+    stack[top++] = root;
+    while(top > 0) {
+        PokemonNode* current = stack[--top];
+        addNode(na, current);
+        if(current->right != NULL) {
+            stack[top++] = current->right;
+        }
+        if(current->left != NULL) {
+            stack[top++] = current->left;
+        }
+    }
+    freeTreeStack(stack, inlineStack);
+}
+
+// Function to copy all given Pokedex tree nodes into a NodeArray, sorted by ID(in-order)
+void flattenInOrder(PokemonNode *root, NodeArray *na) {
+    if(root == NULL || na == NULL) {
+        return;
+    }
+
+    //same in-order walk as inOrderGeneric, adding instead of visiting
+    PokemonNode* inlineStack[TREE_STACK_INLINE];
+    PokemonNode** stack = (PokemonNode **)allocTreeStack(inlineStack, root->height, sizeof(PokemonNode *));
+    int top = 0;
+    PokemonNode* current = root;
+    while(current != NULL || top > 0) {
+        while(current != NULL) {
+            stack[top++] = current;
+            current = current->left;
+        }
+        current = stack[--top];
+        addNode(na, current);
+        current = current->right;
+    }
+    freeTreeStack(stack, inlineStack);
 }
 
 // Function to add a Pokemon node into a given node array
@@ -687,39 +1707,288 @@ void addNode(NodeArray *na, PokemonNode *node) {
 
     //if the capacity was reached - double it
     if(na->size == na->capacity) {
-        na->capacity *= 2;
+        reserveNodeArray(na, na->capacity > 0 ? na->capacity * 2 : 1);
     }
 
-    //reallocate space for one more node in the node array
-    PokemonNode** temp = realloc(na->nodes, na->capacity * sizeof(PokemonNode*));
+    na->nodes[na->size++] = node;
+}
+
+// Function to grow the node array's space to at least a given capacity
+void reserveNodeArray(NodeArray *na, int cap) {
+    if(cap <= na->capacity) {
+        return;
+    }
+    PokemonNode** temp = realloc(na->nodes, cap * sizeof(PokemonNode*));
     if(temp == NULL) {
         printf("Memory allocation failed.\n");
         exit(1);
     }
     na->nodes = temp;
-
-    na->nodes[na->size++] = node;
+    na->capacity = cap;
 }
 
-// Function to compare to Pokemon names for two given Pokemon nodes
-int compareByNameNode(const void *a, const void *b) {
-    PokemonNode* nodeA = *(PokemonNode**)a;
-    PokemonNode* nodeB = *(PokemonNode**)b;
-    char* name1 = myStrdup(nodeA->data->name);
-    char* name2 = myStrdup(nodeB->data->name);
-    int result = strcmp(name1, name2);
-    free(name1);
-    free(name2);
-    return result;
+// Function to free the scratch node array at exit
+void releaseScratchNodes() {
+    free(scratchNodes.nodes);
+    scratchNodes.nodes = NULL;
+    scratchNodes.size = 0;
+    scratchNodes.capacity = 0;
+}
+
+// Function to compare two species by name(and by ID if the names are equal)
+int compareSpeciesByName(const void *a, const void *b) {
+    const PokemonData* speciesA = *(const PokemonData* const*)a;
+    const PokemonData* speciesB = *(const PokemonData* const*)b;
+    int result = strcmp(speciesA->name, speciesB->name);
+    if(result != 0) {
+        return result;
+    }
+    return speciesA->id - speciesB->id;
+}
+
+// --------------------------------------------------------------
+// Order Statistics (rank/select/range count)
+// --------------------------------------------------------------
+
+// Function to count the IDs in a Pokedex tree that are lower than a given ID
+int countPokemonBelow(PokemonNode *root, int id) {
+    int count = 0;
+    while(root != NULL) {
+        //going right skips the whole left subtree and the node itself - all of them are smaller
+        if(root->data->id < id) {
+            count += getNodeSize(root->left) + 1;
+            root = root->right;
+        }
+        else {
+            root = root->left;
+        }
+    }
+    return count;
+}
+
+// Function to find the 1-based position of an ID in ID order(0 if it isn't there)
+int rankOfPokemon(PokemonNode *root, int id) {
+    if(searchPokemonBFS(root, id) == NULL) {
+        return 0;
+    }
+    return countPokemonBelow(root, id) + 1;
+}
+
+// Function to find the node with the k-th lowest ID
+PokemonNode *selectPokemonByRank(PokemonNode *root, int k) {
+    if(k < 1 || k > getNodeSize(root)) {
+        return NULL;
+    }
+    while(root != NULL) {
+        int leftSize = getNodeSize(root->left);
+        if(k <= leftSize) {
+            root = root->left;
+        }
+        else if(k == leftSize + 1) {
+            return root;
+        }
+        else {
+            k -= leftSize + 1;
+            root = root->right;
+        }
+    }
+    return NULL;
+}
+
+// Function to count the IDs of a Pokedex tree in [low, high]
+int countPokemonInRange(PokemonNode *root, int low, int high) {
+    if(low > high) {
+        return 0;
+    }
+    //clamp so that high + 1 can't overflow
+    if(high > POKEDEX_SIZE) {
+        high = POKEDEX_SIZE;
+    }
+    return countPokemonBelow(root, high + 1) - countPokemonBelow(root, low);
+}
+
+// Function to run the order statistic queries on an owner's Pokedex
+void pokedexQueryMenu(OwnerNode *owner) {
+    if(owner->pokedexRoot == NULL) {
+        printf("Pokedex is empty.\n");
+        return;
+    }
+
+    printf("Queries:\n");
+    printf("1. Count Pokemon in an ID range\n");
+    printf("2. Find the k-th lowest ID\n");
+    printf("3. Find the rank of an ID\n");
+
+    int choice = readIntSafe("Your choice: ");
+    switch(choice) {
+        case 1: {
+            int low = readIntSafe("Enter lowest ID: ");
+            int high = readIntSafe("Enter highest ID: ");
+            printf("%d Pokemon with ID in [%d, %d].\n", countPokemonInRange(owner->pokedexRoot, low, high), low, high);
+            break;
+        }
+        case 2: {
+            int k = readIntSafe("Enter k: ");
+            PokemonNode* node = selectPokemonByRank(owner->pokedexRoot, k);
+            if(node == NULL) {
+                printf("No Pokemon at position %d (Pokedex has %d).\n", k, getNodeSize(owner->pokedexRoot));
+                break;
+            }
+            printPokemonNode(node);
+            outFlush();
+            break;
+        }
+        case 3: {
+            int id = readIntSafe("Enter ID: ");
+            int rank = rankOfPokemon(owner->pokedexRoot, id);
+            if(rank == 0) {
+                printf("No Pokemon with ID %d found.\n", id);
+                break;
+            }
+            printf("%s (ID %d) is #%d of %d by ID.\n", pokedex[id - 1].name, id, rank, getNodeSize(owner->pokedexRoot));
+            break;
+        }
+        default:
+            printf("Invalid choice.\n");
+    }
+}
+
+// --------------------------------------------------------------
+// Split / Join (bulk range removal)
+// --------------------------------------------------------------
+
+// Function to join two trees and a middle node between them into one balanced tree
+PokemonNode *joinPokemonTrees(PokemonNode *left, PokemonNode *mid, PokemonNode *right) {
+    // 1) every step goes one level down the taller tree, so this bounds the path
+    PokemonNode** inlinePath[TREE_STACK_INLINE];
+    PokemonNode*** path = (PokemonNode ***)allocTreeStack(inlinePath, getNodeHeight(left) + getNodeHeight(right),
+                                                          sizeof(PokemonNode **));
+    int depth = 0;
+    PokemonNode* root = NULL;
+    PokemonNode** link = &root;
+
+    // 2) while one tree is much taller, keep its root in place and go down its inner spine
+    //    (left's right one, right's left one), remembering every link on the way
+    while(1) {
+        int leftHeight = getNodeHeight(left);
+        int rightHeight = getNodeHeight(right);
+        if(leftHeight > rightHeight + 1) {
+            *link = left;
+            path[depth++] = link;
+            link = &left->right;
+            left = left->right;
+        }
+        else if(rightHeight > leftHeight + 1) {
+            *link = right;
+            path[depth++] = link;
+            link = &right->left;
+            right = right->left;
+        }
+        // 3) similar heights - the middle node simply becomes their root
+        else {
+            mid->left = left;
+            mid->right = right;
+            updateNodeHeightAndSize(mid);
+            *link = mid;
+            break;
+        }
+    }
+
+    // 4) fix the heights on the way back up and rotate where a spine got unbalanced
+    rebalancePath(path, depth);
+    freeTreeStack(path, inlinePath);
+    return root;
+}
+
+// Function to split a tree into the IDs lower than a given ID and the rest
+void splitPokemonTree(PokemonNode *root, int id, PokemonNode **lower, PokemonNode **rest) {
+    *lower = NULL;
+    *rest = NULL;
+    if(root == NULL) {
+        return;
+    }
+
+    // 1) walk down to where the ID would go, remembering the nodes on the way
+    PokemonNode* inlinePath[TREE_STACK_INLINE];
+    PokemonNode** path = (PokemonNode **)allocTreeStack(inlinePath, root->height, sizeof(PokemonNode *));
+    int depth = 0;
+    while(root != NULL) {
+        path[depth++] = root;
+        root = (root->data->id < id) ? root->right : root->left;
+    }
+
+    // 2) deepest first, each node joins the side it belongs to, along with its subtree
+    //    that the walk didn't enter(the left one for a lower node, the right one otherwise)
+    while(depth > 0) {
+        PokemonNode* node = path[--depth];
+        if(node->data->id < id) {
+            *lower = joinPokemonTrees(node->left, node, *lower);
+        }
+        else {
+            *rest = joinPokemonTrees(*rest, node, node->right);
+        }
+    }
+    freeTreeStack(path, inlinePath);
+}
+
+// Function to remove all Pokemon with an ID in [low, high] from a tree in one pass
+PokemonNode *removePokemonRange(PokemonArena *arena, PokemonNode *root, int low, int high, int *removedCount) {
+    *removedCount = 0;
+    //clamp so that high + 1 can't overflow
+    if(low < 1) {
+        low = 1;
+    }
+    if(high > POKEDEX_SIZE) {
+        high = POKEDEX_SIZE;
+    }
+    if(root == NULL || low > high) {
+        return root;
+    }
+
+    // 1) cut the tree into [< low], [low..high] and [> high]
+    PokemonNode* lower;
+    PokemonNode* rest;
+    PokemonNode* inRange;
+    PokemonNode* higher;
+    splitPokemonTree(root, low, &lower, &rest);
+    splitPokemonTree(rest, high + 1, &inRange, &higher);
+
+    // 2) free the middle part as a whole
+    *removedCount = getNodeSize(inRange);
+    freePokemonTree(arena, inRange);
+
+    // 3) join the sides back - the smallest higher ID becomes the middle node
+    if(higher == NULL) {
+        return lower;
+    }
+    PokemonNode* minNode;
+    PokemonNode* higherRest;
+    splitPokemonTree(higher, findMinTreeElement(higher)->data->id + 1, &minNode, &higherRest);
+    return joinPokemonTrees(lower, minNode, higherRest);
 }
 
 // --------------------------------------------------------------
 // Pokemon Releasing
 // --------------------------------------------------------------
 
+// Function to build a perfectly balanced tree out of nodes sorted by ID
+PokemonNode *buildBalancedTree(PokemonNode **nodes, int count) {
+    if(count <= 0) {
+        return NULL;
+    }
+
+    //the middle node becomes the root, each half becomes one of its subtrees
+    int middle = count / 2;
+    PokemonNode* root = nodes[middle];
+    root->left = buildBalancedTree(nodes, middle);
+    root->right = buildBalancedTree(nodes + middle + 1, count - middle - 1);
+    updateNodeHeightAndSize(root);
+    return root;
+}
+
 // Function to find the min element in a BST
 PokemonNode* findMinTreeElement(PokemonNode* root) {
-    PokemonNode* minFinder = root->right;
+    PokemonNode* minFinder = root;
 
     //find the leftmost member of the tree
     while(minFinder != NULL && minFinder->left != NULL) {
@@ -729,49 +1998,68 @@ PokemonNode* findMinTreeElement(PokemonNode* root) {
 }
 
 // Function to remove the node from the tree based on its ID
-PokemonNode *removeNodeBST(PokemonNode *root, int id) {
-    // 1) If the id isn't found - return
-    if(root == NULL) {
-        printf("No Pokemon with ID %d found.\n", id);
+PokemonNode *removeNodeBST(PokemonArena *arena, PokemonNode *root, int id) {
+    PokemonNode** inlinePath[TREE_STACK_INLINE];
+    PokemonNode*** path = (PokemonNode ***)allocTreeStack(inlinePath, getNodeHeight(root), sizeof(PokemonNode **));
+    int depth = 0;
+
+    // 1) Walk down by ID(smaller goes left, larger goes right), remembering every link on the way
+    PokemonNode** link = &root;
+    while(*link != NULL && (*link)->data->id != id) {
+        path[depth++] = link;
+        link = (id < (*link)->data->id) ? &(*link)->left : &(*link)->right;
+    }
+
+    // 2) If the id isn't found - return(the callers check ownership and report it first)
+    if(*link == NULL) {
+        freeTreeStack(path, inlinePath);
         return root;
     }
 
-    // 2) If ID is smaller go left
-    if(id < root->data->id) {
-        root->left = removePokemonByID(root->left, id);
+    // 3) If ID has been found:
+    PokemonNode* target = *link;
+    // 3.1) If there is only one child from the right
+    if(target->left == NULL) {
+        *link = target->right;
     }
-    // 3) If ID is larger go right
-    else if(id > root->data->id) {
-        root->right = removePokemonByID(root->right, id);
+    // 3.2) If there is only one child from the left
+    else if(target->right == NULL) {
+        *link = target->left;
     }
-    // 4) If ID has been found:
+    // 3.3) If the node has two children - unlink the successor and put it in the node's place
     else {
-        printf("Removing Pokemon %s (ID %d).\n", pokedex[id - 1].name, id);
-        // 4.1) If there is only one child from the right
-        if(root->left == NULL) {
-            PokemonNode* temp = root->right;
-            freePokemonNode(root);
-            return temp;
-        }
-        // 4.2) If there is only one child from the left
-        if(root->right == NULL) {
-            PokemonNode* temp = root->left;
-            freePokemonNode(root);
-            return temp;
-        }
-        // 4.3) If the node has two children - find the successor, copy its data and free it
-        PokemonNode* temp = findMinTreeElement(root->right);
-        freePokemonData(root->data);
-        root->data = temp->data;
-        root->right = removePokemonByID(root->right, temp->data->id);
+        int targetDepth = depth;
+        path[depth++] = link;
+
+        //the successor is the leftmost node of the right subtree
+        PokemonNode** successorLink = &target->right;
+        while((*successorLink)->left != NULL) {
+            path[depth++] = successorLink;
+            successorLink = &(*successorLink)->left;
+        }
+        PokemonNode* successor = *successorLink;
+        *successorLink = successor->right;
+
+        successor->left = target->left;
+        successor->right = target->right;
+        *link = successor;
+
+        //the link below the target belonged to the freed node - it's the successor's now
+        if(depth > targetDepth + 1) {
+            path[targetDepth + 1] = &successor->right;
+        }
     }
+    freePokemonNode(arena, target);
 
+    // 4) Fix the heights on the way back up and rotate where a subtree got unbalanced
+    rebalancePath(path, depth);
+    freeTreeStack(path, inlinePath);
     return root;
 }
 
 // Function to search for a node to delete and get rid of it if found
-PokemonNode *removePokemonByID(PokemonNode *root, int id) {
-    root = removeNodeBST(root ,id);
+PokemonNode *removePokemonByID(PokemonArena *arena, PokemonNode *root, int id) {
+    root = removeNodeBST(arena, root ,id);
 
     return root;
 }
@@ -786,8 +2074,133 @@ void freePokemon(OwnerNode *owner) {
     // 2) Get the ID of the Pokemon the user wishes to release
     int idToFree = readIntSafe("Enter Pokemon ID to release: ");
 
-    // 3) Remove the Pokemon's node from the Owner's Pokemon tree
-    owner->pokedexRoot = removePokemonByID(owner->pokedexRoot, idToFree);
+    // 3) Release it
+    if(releasePokemonCore(owner, idToFree) == OP_NOT_OWNED) {
+        printf("No Pokemon with ID %d found.\n", idToFree);
+    }
+    else {
+        printf("Removing Pokemon %s (ID %d).\n", pokedex[idToFree - 1].name, idToFree);
+    }
+}
+
+// Function to release a Pokemon from an owner's Pokedex without printing anything
+OpStatus releasePokemonCore(OwnerNode *owner, int id) {
+    if(owner->pokedexRoot == NULL) {
+        return OP_EMPTY;
+    }
+
+    // 1) A single bit test tells if there is anything to remove
+    if(!ownerHasPokemon(owner, id)) {
+        return OP_NOT_OWNED;
+    }
+
+    // 2) Remove the Pokemon's node from the Owner's Pokemon tree
+    owner->pokedexRoot = removePokemonByID(&owner->arena, owner->pokedexRoot, id);
+    setPokemonOwned(owner, id, 0);
+    journalOwnerOp(JOURNAL_RELEASE, owner, 0, (uint32_t)id);
+    return OP_OK;
+}
+
+// Function to release all the Pokemon in an ID range(prompted to user prior)
+void freePokemonRange(OwnerNode *owner) {
+    // 1) If the Pokedex is empty - print message and return
+    if(owner->pokedexRoot == NULL) {
+        printf("No Pokemon to release.\n");
+        return;
+    }
+    // 2) Get the range of IDs the user wishes to release
+    int low = readIntSafe("Enter lowest ID to release: ");
+    int high = readIntSafe("Enter highest ID to release: ");
+
+    // 3) Cut the whole range out of the tree at once
+    int removed = releasePokemonRangeCore(owner, low, high);
+    if(removed == 0) {
+        printf("No Pokemon with ID in [%d, %d] found.\n", low, high);
+        return;
+    }
+    printf("Released %d Pokemon with ID in [%d, %d].\n", removed, low, high);
+}
+
+// Function to release every Pokemon in an ID range without printing anything
+int releasePokemonRangeCore(OwnerNode *owner, int low, int high) {
+    int removed = 0;
+    owner->pokedexRoot = removePokemonRange(&owner->arena, owner->pokedexRoot, low, high, &removed);
+    if(removed == 0) {
+        return 0;
+    }
+
+    //clear the bits of the range(only IDs that were set move the count)
+    int first = (low < 1) ? 1 : low;
+    int last = (high > POKEDEX_SIZE) ? POKEDEX_SIZE : high;
+    for(int id = first; id <= last; id++) {
+        setPokemonOwned(owner, id, 0);
+    }
+    journalOwnerOp(JOURNAL_RELEASE_RANGE, owner, (uint16_t)last, (uint32_t)first);
+    return removed;
+}
+
+// Function to print the number of Pokemon of every type an owner has
+void displayTypeHistogram(const OwnerNode *owner) {
+    for(int type = 0; type < TYPE_COUNT; type++) {
+        outWrite(typeNames[type].name, typeNames[type].length);
+        outWrite(": ", 2);
+        outInt(owner->stats.typeCounts[type]);
+        outWrite("\n", 1);
+    }
+    outFlush();
+}
+
+// Function to print an owner's Pokemon of a given type, by ID
+void displayPokemonOfType(const OwnerNode *owner, PokemonType type) {
+    if(owner->stats.typeCounts[type] == 0) {
+        printf("No %s Pokemon.\n", typeNames[type].name);
+        return;
+    }
+
+    //only the set bits of the intersection are visited
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        for(uint64_t bits = owner->pokedexBits[w] & typeSpeciesBits[type][w]; bits != 0; bits &= bits - 1) {
+            printSpeciesRow(&pokedex[w * 64 + lowestSetBit(bits)]);
+        }
+    }
+    outFlush();
+}
+
+// Function to show the type histogram or one type's Pokemon of an owner
+void pokedexTypeMenu(OwnerNode *owner) {
+    if(owner->pokedexRoot == NULL) {
+        printf("Pokedex is empty.\n");
+        return;
+    }
+
+    printf("By Type:\n");
+    printf("1. Count per type\n");
+    printf("2. Show one type\n");
+
+    int choice = readIntSafe("Your choice: ");
+    switch(choice) {
+        case 1:
+            displayTypeHistogram(owner);
+            break;
+        case 2: {
+            for(int type = 0; type < TYPE_COUNT; type++) {
+                outInt(type + 1);
+                outWrite(". ", 2);
+                outWrite(typeNames[type].name, typeNames[type].length);
+                outWrite("\n", 1);
+            }
+            outFlush();
+            int type = readIntSafe("Choose a type: ");
+            if(type < 1 || type > TYPE_COUNT) {
+                printf("Invalid choice.\n");
+                break;
+            }
+            displayPokemonOfType(owner, (PokemonType)(type - 1));
+            break;
+        }
+        default:
+            printf("Invalid choice.\n");
+    }
 }
 
 // --------------------------------------------------------------
@@ -805,187 +2218,624 @@ void pokemonFight(OwnerNode *owner) {
     battleIds[0] = readIntSafe("Enter ID of the first Pokemon: ");
     battleIds[1] = readIntSafe("Enter ID of the second Pokemon: ");
 
-    // 3) Check for both Pokemon in the Pokedex
-    PokemonNode* searchResults[2];
+    // 3) Check for both Pokemon in the Pokedex - the species record is all we need from them
+    const PokemonData* searchResults[2];
     for(int i = 0; i < 2; i++) {
-        searchResults[i] = searchPokemonBFS(owner->pokedexRoot, battleIds[i]);
-        if(searchResults[i] == NULL) {
+        if(!ownerHasPokemon(owner, battleIds[i])) {
             printf("One or both Pokemon IDs not found.\n");
             return;
         }
+        searchResults[i] = getSpeciesData(battleIds[i]);
     }
 
     // 4) If both are in the Pokedex - Fight!
+    printFightResult(searchResults[0], searchResults[1]);
+}
+
+// Function to print a fight between two species and its outcome
+void printFightResult(const PokemonData *first, const PokemonData *second) {
+    const PokemonData* fighters[2] = {first, second};
     float scores[2];
     //print the Pokemon and their scores
     for(int i = 0; i < 2; i++) {
-        scores[i] = (float)(searchResults[i]->data->attack * 1.5) + (float)(searchResults[i]->data->hp * 1.2);
-        printf("Pokemon %d: %s (Score = %.2f)\n", i + 1, searchResults[i]->data->name, scores[i]);
+        scores[i] = fightScore(fighters[i]);
+        printf("Pokemon %d: %s (Score = %.2f)\n", i + 1, fighters[i]->name, scores[i]);
     }
 
-    // 5) Handle different outcome cases
+    //handle different outcome cases
     if(scores[0] > scores[1]) {
-        printf("%s wins!\n", searchResults[0]->data->name);
+        printf("%s wins!\n", fighters[0]->name);
     }
     else if(scores[1] > scores[0]) {
-        printf("%s wins!\n", searchResults[1]->data->name);
+        printf("%s wins!\n", fighters[1]->name);
     }
     else {
         printf("It's a tie!\n");
     }
 }
 
-// --------------------------------------------------------------
-// Pokemon Evolution
-// --------------------------------------------------------------
-void evolvePokemon(OwnerNode *owner) {
-    // 1) If the owner has no Pokemon - print message and return
-    if(owner->pokedexRoot == NULL) {
-        printf("Cannot evolve. Pokedex empty.\n");
+// Function to compute the battle score of a species
+float fightScore(const PokemonData *data) {
+    return (float)(data->attack * 1.5) + (float)(data->hp * 1.2);
+}
+
+// Function to append an owner's species(by ID order) to a list of fight participants
+int collectFightParticipants(const OwnerNode *owner, const PokemonData **species, int start) {
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        for(uint64_t bits = owner->pokedexBits[w]; bits != 0; bits &= bits - 1) {
+            species[start++] = &pokedex[w * 64 + lowestSetBit(bits)];
+        }
+    }
+    return start;
+}
+
+// Function to score a list of fight participants into a flat array
+void computeFightScores(const PokemonData **species, float *scores, int count) {
+    //every species' score is already in the table
+    for(int i = 0; i < count; i++) {
+        scores[i] = speciesScore[species[i]->id - 1];
+    }
+}
+
+// Function to compare two floats for qsort
+int compareFloats(const void *a, const void *b) {
+    float first = *(const float*)a;
+    float second = *(const float*)b;
+    return (first > second) - (first < second);
+}
+
+// Function to count the wins and ties of every participant against all the others
+void countFightOutcomes(const float *scores, int count, int *wins, int *ties) {
+    if(count <= 0) {
         return;
     }
+    float* sorted = malloc((size_t)count * sizeof(float));
+    if(sorted == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    memcpy(sorted, scores, (size_t)count * sizeof(float));
+    qsort(sorted, count, sizeof(float), compareFloats);
+
+    for(int i = 0; i < count; i++) {
+        //first sorted index with a score >= ours: everyone before it loses to us
+        int low = 0;
+        int high = count;
+        while(low < high) {
+            int middle = low + (high - low) / 2;
+            if(sorted[middle] < scores[i]) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        int firstEqual = low;
+        //first sorted index with a score > ours
+        high = count;
+        while(low < high) {
+            int middle = low + (high - low) / 2;
+            if(sorted[middle] <= scores[i]) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        wins[i] = firstEqual;
+        //minus ourselves
+        ties[i] = low - firstEqual - 1;
+    }
 
-    // 2) Get the ID of the Pokemon to evolve and try to locate it
-    int idToEvolve = readIntSafe("Enter ID of Pokemon to evolve: ");
-    PokemonNode* pokemonToEvolve = searchPokemonBFS(owner->pokedexRoot, idToEvolve);
-    if(pokemonToEvolve == NULL) {
-        printf("No Pokemon with ID %d found.\n", idToEvolve);
+    free(sorted);
+}
+
+// Function to print one participant's fight totals
+void printFightRow(const OwnerNode *owner, const PokemonData *data, int wins, int ties, int losses) {
+    if(owner != NULL) {
+        outWrite("[", 1);
+        outString(owner->ownerName);
+        outWrite("] ", 2);
+    }
+    outWrite("ID: ", 4);
+    outInt(data->id);
+    outWrite(", Name: ", 8);
+    outString(data->name);
+    outWrite(", Wins: ", 8);
+    outInt(wins);
+    outWrite(", Losses: ", 10);
+    outInt(losses);
+    outWrite(", Ties: ", 8);
+    outInt(ties);
+    outWrite("\n", 1);
+}
+
+// Function to let every Pokemon of an owner fight every other one
+void fightEveryoneMenu(OwnerNode *owner) {
+    if(owner->pokedexRoot == NULL) {
+        printf("Pokedex is empty.\n");
         return;
     }
 
-    // 3) Check if the Pokemon can evolve
-    if(pokemonToEvolve->data->CAN_EVOLVE == CANNOT_EVOLVE){
-        printf("%s (ID %d) cannot evolve.\n", pokemonToEvolve->data->name, pokemonToEvolve->data->id);
+    printf("Fight Everyone:\n");
+    printf("1. Win/lose/tie matrix\n");
+    printf("2. Win counts\n");
+    int choice = readIntSafe("Your choice: ");
+    if(choice != 1 && choice != 2) {
+        printf("Invalid choice.\n");
         return;
     }
 
-    //if the evolved form already exists in the Pokedex - release the unevolved form
-    if(searchPokemonBFS(owner->pokedexRoot, idToEvolve + 1) != NULL) {
-        printf("Evolution ID %d (%s) already in the Pokedex. Releasing %s (ID %d).\n",
-                      idToEvolve + 1,
-                      pokedex[idToEvolve].name,
-                      pokedex[idToEvolve - 1].name,
-                      idToEvolve);
-        owner->pokedexRoot = removePokemonByID(owner->pokedexRoot, idToEvolve);
+    // 1) all participants(at most one per species) and their scores
+    const PokemonData* species[POKEDEX_SIZE];
+    float scores[POKEDEX_SIZE];
+    int count = collectFightParticipants(owner, species, 0);
+    computeFightScores(species, scores, count);
+
+    // 2) the matrix: one row per Pokemon, one character per opponent(W/L/T, '-' against itself)
+    if(choice == 1) {
+        printf("Rows fight columns, both in ID order.\n");
+        for(int i = 0; i < count; i++) {
+            outInt(species[i]->id);
+            outWrite(": ", 2);
+            for(int j = 0; j < count; j++) {
+                char outcome = (i == j) ? '-' : (scores[i] > scores[j]) ? 'W' : (scores[i] < scores[j]) ? 'L' : 'T';
+                outWrite(&outcome, 1);
+            }
+            outWrite("\n", 1);
+        }
+        outFlush();
         return;
     }
 
-    //if the Pokemon can evolve - remove the old form and insert the new
-    owner->pokedexRoot = removePokemonByID(owner->pokedexRoot, idToEvolve);
-    PokemonData* evolutionData = createPokemonData(pokedex[idToEvolve]);
-    PokemonNode* evolvedPokemon = createPokemonNode(evolutionData);
-    owner->pokedexRoot = insertPokemonNode(owner->pokedexRoot, evolvedPokemon);
-    printf("Pokemon evolved from %s (ID %d) to %s (ID %d).\n",
-                  pokedex[idToEvolve - 1].name,
-                  idToEvolve,
-                  pokedex[idToEvolve].name,
-                  idToEvolve + 1);
+    // 3) the win counts
+    int wins[POKEDEX_SIZE];
+    int ties[POKEDEX_SIZE];
+    countFightOutcomes(scores, count, wins, ties);
+    for(int i = 0; i < count; i++) {
+        printFightRow(NULL, species[i], wins[i], ties[i], count - 1 - wins[i] - ties[i]);
+    }
+    outFlush();
 }
 
-// --------------------------------------------------------------
-// Sub-menu for existing Pokedex
-// --------------------------------------------------------------
-void enterExistingPokedexMenu()
-{
-    //make sure the list isn't empty
+// Function to let every Pokemon of every owner fight every other one
+void fightAllOwners() {
     if(ownerHead == NULL) {
-        printf("No existing Pokedexes.\n");
+        printf("No owners.\n");
         return;
     }
 
-    // list owners
-    printf("\nExisting Pokedexes:\n");
-    printAllOwners();
+    // 1) size everything exactly from the per-owner counts
+    long total = 0;
+    OwnerNode* owner = ownerHead;
+    do {
+        total += owner->stats.pokemonCount;
+        owner = owner->next;
+    } while(owner != NULL && owner != ownerHead);
+    if(total == 0) {
+        printf("No Pokemon to fight.\n");
+        return;
+    }
+    int count = (int)total;
+
+    const PokemonData** species = malloc((size_t)count * sizeof(const PokemonData*));
+    const OwnerNode** owners = malloc((size_t)count * sizeof(const OwnerNode*));
+    float* scores = malloc((size_t)count * sizeof(float));
+    int* wins = malloc((size_t)count * sizeof(int));
+    int* ties = malloc((size_t)count * sizeof(int));
+    if(species == NULL || owners == NULL || scores == NULL || wins == NULL || ties == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
 
-    //get owner choice from the user
-    int pokedexChoice = readIntSafe("Choose a Pokedex by number: ");
+    // 2) collect every owner's participants in ring order, then score and count them all at once
+    int filled = 0;
+    owner = ownerHead;
+    do {
+        int next = collectFightParticipants(owner, species, filled);
+        while(filled < next) {
+            owners[filled++] = owner;
+        }
+        owner = owner->next;
+    } while(owner != NULL && owner != ownerHead);
+    computeFightScores(species, scores, count);
+    countFightOutcomes(scores, count, wins, ties);
 
-    //try to find the owner in the list
-    OwnerNode* cur = findOwnerByPosition(pokedexChoice - 1);
+    for(int i = 0; i < count; i++) {
+        printFightRow(owners[i], species[i], wins[i], ties[i], count - 1 - wins[i] - ties[i]);
+    }
+    outFlush();
 
-    printf("\nEntering %s's Pokedex...\n", cur->ownerName);
+    free(species);
+    free(owners);
+    free(scores);
+    free(wins);
+    free(ties);
+}
 
-    int subChoice;
-    do
-    {
-        printf("\n-- %s's Pokedex Menu --\n", cur->ownerName);
-        printf("1. Add Pokemon\n");
-        printf("2. Display Pokedex\n");
-        printf("3. Release Pokemon (by ID)\n");
-        printf("4. Pokemon Fight!\n");
-        printf("5. Evolve Pokemon\n");
-        printf("6. Back to Main\n");
+// --------------------------------------------------------------
+// Battle Simulation
+// --------------------------------------------------------------
 
-        subChoice = readIntSafe("Your choice: ");
+// Function to get the next number of a splitmix64 generator
+uint64_t nextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
 
-        switch (subChoice)
-        {
-        case 1:
-            addPokemon(cur);
-            break;
-        case 2:
-            displayMenu(cur);
-            break;
-        case 3:
-            freePokemon(cur);
-            break;
-        case 4:
-            pokemonFight(cur);
-            break;
-        case 5:
-            evolvePokemon(cur);
-            break;
-        case 6:
-            printf("Back to Main Menu.\n");
-            break;
-        default:
-            printf("Invalid choice.\n");
+// Function to simulate one battle - the attackers take turns until one side runs out of HP
+int simulateBattle(const PokemonData *first, const PokemonData *second, uint64_t *rngState) {
+    const PokemonData* fighters[2] = {first, second};
+    int hp[2] = {first->hp, second->hp};
+    //the multipliers don't change during the battle
+    int effectiveness[2] = {
+        typeEffectiveness[first->TYPE][second->TYPE],
+        typeEffectiveness[second->TYPE][first->TYPE]
+    };
+
+    uint64_t random = nextRandom(rngState);
+    int attacker = (int)(random & 1);
+    for(int turn = 0; turn < BATTLE_MAX_TURNS; turn++) {
+        //a fresh roll every 4 turns - each turn uses 16 bits of it
+        if(turn % 4 == 0) {
+            random = nextRandom(rngState);
         }
-    } while (subChoice != 6);
-}
+        int roll = 85 + (int)((random >> (16 * (turn % 4))) & 0xFFFF) % 16;
 
-// Function to free given Pokemon data in its entirety
-void freePokemonData(PokemonData *data) {
-    // 1) if the data is empty - go back
-    if(data == NULL) {
+        //attack * multiplier(in halves) * roll(85-100%), a quarter of it lands
+        int damage = fighters[attacker]->attack * effectiveness[attacker] * roll / 800;
+        if(damage == 0 && effectiveness[attacker] != 0) {
+            damage = 1;
+        }
+        hp[1 - attacker] -= damage;
+        if(hp[1 - attacker] <= 0) {
+            return attacker == 0 ? 1 : -1;
+        }
+        attacker = 1 - attacker;
+    }
+    return 0;
+}
+
+// Function run by each simulation thread
+void *battleWorkerMain(void *arg) {
+    BattleWorker* worker = (BattleWorker *)arg;
+    BattleSimulation* simulation = worker->simulation;
+
+    for(int pair = worker->index; pair < simulation->pairCount; pair += simulation->workerCount) {
+        //every pairing has its own stream, whichever thread runs it
+        worker->rngState = simulation->seed ^ ((uint64_t)(pair + 1) * 0xD1B54A32D192ED03ULL);
+        const PokemonData* first = simulation->species[simulation->pairFirst[pair]];
+        const PokemonData* second = simulation->species[simulation->pairSecond[pair]];
+        int wins = 0;
+        int ties = 0;
+        for(int trial = 0; trial < simulation->trials; trial++) {
+            int result = simulateBattle(first, second, &worker->rngState);
+            wins += (result == 1);
+            ties += (result == 0);
+        }
+        //each pairing belongs to one worker, so the results need no locking
+        simulation->pairWins[pair] = wins;
+        simulation->pairTies[pair] = ties;
+    }
+    return NULL;
+}
+
+// Function to run all the pairings of a simulation over a pool of threads
+void runBattleSimulation(BattleSimulation *simulation) {
+    int workerCount = simulation->workerCount;
+    if(workerCount > simulation->pairCount) {
+        workerCount = simulation->pairCount > 0 ? simulation->pairCount : 1;
+    }
+    simulation->workerCount = workerCount;
+
+    BattleWorker workers[BATTLE_MAX_WORKERS];
+    pthread_t threads[BATTLE_MAX_WORKERS];
+    int started[BATTLE_MAX_WORKERS];
+
+    // 1) workers 1..n-1 get their own threads, worker 0 runs on this one
+    for(int w = 0; w < workerCount; w++) {
+        workers[w].simulation = simulation;
+        workers[w].index = w;
+        workers[w].rngState = 0;
+        started[w] = 0;
+    }
+    for(int w = 1; w < workerCount; w++) {
+        started[w] = (pthread_create(&threads[w], NULL, battleWorkerMain, &workers[w]) == 0);
+    }
+    battleWorkerMain(&workers[0]);
+
+    // 2) wait for the threads - a worker whose thread couldn't start runs here instead
+    for(int w = 1; w < workerCount; w++) {
+        if(started[w]) {
+            pthread_join(threads[w], NULL);
+        }
+        else {
+            battleWorkerMain(&workers[w]);
+        }
+    }
+}
+
+// Function to get the number of worker threads to use by default
+int defaultWorkerCount() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cpus < 1) {
+        return 1;
+    }
+    return cpus > BATTLE_MAX_WORKERS ? BATTLE_MAX_WORKERS : (int)cpus;
+}
+
+// Function to simulate battles between all the Pokemon of an owner
+void battleSimulationMenu(OwnerNode *owner) {
+    if(owner->stats.pokemonCount < 2) {
+        printf("Need at least 2 Pokemon to simulate.\n");
         return;
     }
 
-    // 2) free all data contents
-    free(data->name);
-    data->name = NULL;
-    free(data);
-    data = NULL;
+    // 1) get the simulation settings from the user
+    int trials = readIntSafe("Trials per pairing: ");
+    if(trials < 1) {
+        printf("Invalid number of trials.\n");
+        return;
+    }
+    int threads = readIntSafe("Threads (0 = all CPUs): ");
+    if(threads <= 0) {
+        threads = defaultWorkerCount();
+    }
+    if(threads > BATTLE_MAX_WORKERS) {
+        threads = BATTLE_MAX_WORKERS;
+    }
+    int seed = readIntSafe("Seed: ");
+
+    // 2) participants and every pairing between them
+    const PokemonData* species[POKEDEX_SIZE];
+    int count = collectFightParticipants(owner, species, 0);
+    int pairCount = count * (count - 1) / 2;
+    BattleSimulation simulation;
+    simulation.species = species;
+    simulation.count = count;
+    simulation.pairFirst = malloc((size_t)pairCount * 2);
+    simulation.pairWins = malloc((size_t)pairCount * 2 * sizeof(int));
+    if(simulation.pairFirst == NULL || simulation.pairWins == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    simulation.pairSecond = simulation.pairFirst + pairCount;
+    simulation.pairTies = simulation.pairWins + pairCount;
+    simulation.pairCount = pairCount;
+    simulation.trials = trials;
+    simulation.seed = (uint64_t)(unsigned int)seed * 0x9E3779B97F4A7C15ULL;
+    simulation.workerCount = threads;
+    int pair = 0;
+    for(int i = 0; i < count; i++) {
+        for(int j = i + 1; j < count; j++) {
+            simulation.pairFirst[pair] = (unsigned char)i;
+            simulation.pairSecond[pair] = (unsigned char)j;
+            pair++;
+        }
+    }
+
+    // 3) run it
+    runBattleSimulation(&simulation);
+
+    // 4) fold the pairings back into per-Pokemon totals
+    long wins[POKEDEX_SIZE];
+    long ties[POKEDEX_SIZE];
+    memset(wins, 0, sizeof(wins));
+    memset(ties, 0, sizeof(ties));
+    for(int p = 0; p < pairCount; p++) {
+        int first = simulation.pairFirst[p];
+        int second = simulation.pairSecond[p];
+        wins[first] += simulation.pairWins[p];
+        wins[second] += trials - simulation.pairWins[p] - simulation.pairTies[p];
+        ties[first] += simulation.pairTies[p];
+        ties[second] += simulation.pairTies[p];
+    }
+
+    printf("Simulated %ld battles.\n", (long)pairCount * trials);
+    long battlesEach = (long)trials * (count - 1);
+    for(int i = 0; i < count; i++) {
+        outWrite("ID: ", 4);
+        outInt(species[i]->id);
+        outWrite(", Name: ", 8);
+        outString(species[i]->name);
+        outWrite(", Win: ", 7);
+        outFraction(wins[i], battlesEach);
+        outWrite(", Tie: ", 7);
+        outFraction(ties[i], battlesEach);
+        outWrite("\n", 1);
+    }
+    outFlush();
+
+    free(simulation.pairFirst);
+    free(simulation.pairWins);
 }
 
-// Function to free the entire data of a given Pokemon Node
-void freePokemonNode(PokemonNode *node) {
-    // 1) if the node is empty - go back
-    if (node == NULL) {
+// --------------------------------------------------------------
+// Pokemon Evolution
+// --------------------------------------------------------------
+void evolvePokemon(OwnerNode *owner) {
+    // 1) If the owner has no Pokemon - print message and return
+    if(owner->pokedexRoot == NULL) {
+        printf("Cannot evolve. Pokedex empty.\n");
         return;
     }
 
-    // 2) free all the node's Pokemon data
-    freePokemonData(node->data);
+    // 2) Get the ID of the Pokemon to evolve and evolve it
+    int idToEvolve = readIntSafe("Enter ID of Pokemon to evolve: ");
+    switch(evolvePokemonCore(owner, idToEvolve)) {
+        case OP_NOT_OWNED:
+            printf("No Pokemon with ID %d found.\n", idToEvolve);
+            break;
+        case OP_CANNOT_EVOLVE:
+            printf("%s (ID %d) cannot evolve.\n", pokedex[idToEvolve - 1].name, idToEvolve);
+            break;
+        case OP_EVOLUTION_OWNED:
+            printf("Evolution ID %d (%s) already in the Pokedex. Releasing %s (ID %d).\n",
+                          idToEvolve + 1,
+                          pokedex[idToEvolve].name,
+                          pokedex[idToEvolve - 1].name,
+                          idToEvolve);
+            printf("Removing Pokemon %s (ID %d).\n", pokedex[idToEvolve - 1].name, idToEvolve);
+            break;
+        default:
+            printf("Removing Pokemon %s (ID %d).\n", pokedex[idToEvolve - 1].name, idToEvolve);
+            printf("Pokemon evolved from %s (ID %d) to %s (ID %d).\n",
+                          pokedex[idToEvolve - 1].name,
+                          idToEvolve,
+                          pokedex[idToEvolve].name,
+                          idToEvolve + 1);
+    }
+}
+
+// Function to evolve a Pokemon without printing anything
+OpStatus evolvePokemonCore(OwnerNode *owner, int id) {
+    if(owner->pokedexRoot == NULL) {
+        return OP_EMPTY;
+    }
+
+    // 1) Check that the owner has it
+    if(!ownerHasPokemon(owner, id)) {
+        return OP_NOT_OWNED;
+    }
+
+    // 2) Check if the Pokemon can evolve
+    if(getSpeciesData(id)->CAN_EVOLVE == CANNOT_EVOLVE) {
+        return OP_CANNOT_EVOLVE;
+    }
+
+    journalOwnerOp(JOURNAL_EVOLVE, owner, 0, (uint32_t)id);
 
-    // 3) free the node itself
-    free(node);
-    node = NULL;
+    //if the evolved form already exists in the Pokedex - release the unevolved form
+    if(ownerHasPokemon(owner, id + 1)) {
+        owner->pokedexRoot = removePokemonByID(&owner->arena, owner->pokedexRoot, id);
+        setPokemonOwned(owner, id, 0);
+        return OP_EVOLUTION_OWNED;
+    }
+
+    //if the Pokemon can evolve - point the node at the next species record.
+    //no other ID fits between id and id + 1, so the node keeps its place in the tree
+    PokemonNode* pokemonToEvolve = searchPokemonBFS(owner->pokedexRoot, id);
+    pokemonToEvolve->data = getSpeciesData(id + 1);
+    leaderboardUpdate(pokemonToEvolve);
+    setPokemonOwned(owner, id, 0);
+    setPokemonOwned(owner, id + 1, 1);
+    return OP_OK;
 }
 
-// Function to free all nodes of an owner's Pokedex tree
-void freePokemonTree(PokemonNode *root) {
+// --------------------------------------------------------------
+// Sub-menu for existing Pokedex
+// --------------------------------------------------------------
+void enterExistingPokedexMenu()
+{
+    //make sure the list isn't empty
+    if(ownerHead == NULL) {
+        printf("No existing Pokedexes.\n");
+        return;
+    }
+
+    // list owners
+    printf("\nExisting Pokedexes:\n");
+    printAllOwners();
+
+    //get owner choice from the user
+    int pokedexChoice = readIntSafe("Choose a Pokedex by number: ");
+
+    //try to find the owner in the list
+    OwnerNode* cur = findOwnerByPosition(pokedexChoice - 1);
+
+    printf("\nEntering %s's Pokedex...\n", cur->ownerName);
+
+    int subChoice;
+    do
+    {
+        printf("\n-- %s's Pokedex Menu --\n", cur->ownerName);
+        printf("1. Add Pokemon\n");
+        printf("2. Display Pokedex\n");
+        printf("3. Release Pokemon (by ID)\n");
+        printf("4. Pokemon Fight!\n");
+        printf("5. Evolve Pokemon\n");
+        printf("6. Back to Main\n");
+        printf("7. Pokedex Queries (range/k-th/rank)\n");
+        printf("8. Release Pokemon (by ID range)\n");
+        printf("9. Pokemon by Type\n");
+        printf("10. Fight Everyone\n");
+        printf("11. Battle Simulation\n");
+
+        subChoice = readIntSafe("Your choice: ");
+
+        switch (subChoice)
+        {
+        case 1:
+            addPokemon(cur);
+            break;
+        case 2:
+            displayMenu(cur);
+            break;
+        case 3:
+            freePokemon(cur);
+            break;
+        case 4:
+            pokemonFight(cur);
+            break;
+        case 5:
+            evolvePokemon(cur);
+            break;
+        case 6:
+            printf("Back to Main Menu.\n");
+            break;
+        case 7:
+            pokedexQueryMenu(cur);
+            break;
+        case 8:
+            freePokemonRange(cur);
+            break;
+        case 9:
+            pokedexTypeMenu(cur);
+            break;
+        case 10:
+            fightEveryoneMenu(cur);
+            break;
+        case 11:
+            battleSimulationMenu(cur);
+            break;
+        default:
+            printf("Invalid choice.\n");
+        }
+    } while (subChoice != 6);
+}
+
+// Function to free the entire data of a given Pokemon Node
+void freePokemonNode(PokemonArena *arena, PokemonNode *node) {
     // 1) if the node is empty - go back
-    if(root == NULL) {
+    if (node == NULL) {
         return;
     }
 
-    // 2) go node by node recursively and free its contents
-    freePokemonTree(root->left);
-    freePokemonTree(root->right);
+    // 2) the species data is shared, so only the node's slot goes back to the arena
+    leaderboardRemove(node);
+    node->data = NULL;
+    releasePokemonSlot(arena, node);
+}
 
-    // 3) free the node's Pokemon data
-    freePokemonNode(root);
+// Function to free all nodes of an owner's Pokedex tree
+void freePokemonTree(PokemonArena *arena, PokemonNode *root) {
+    //no stack at all: rotate left children up until the root has none, then free it and
+    //continue with its right subtree - every node is rotated at most once and freed once
+    while(root != NULL) {
+        if(root->left != NULL) {
+            PokemonNode* leftChild = root->left;
+            root->left = leftChild->right;
+            leftChild->right = root;
+            root = leftChild;
+        }
+        else {
+            PokemonNode* next = root->right;
+            freePokemonNode(arena, root);
+            root = next;
+        }
+    }
 }
 
 // Function to free the entirety of an owner's Pokedex data
@@ -995,12 +2845,28 @@ void freeOwnerNode(OwnerNode *owner) {
         return;
     }
 
-    // 2) free trainer name data
+    // 2) free trainer name data(and its journal ID)
+    if(owner->journalId >= 0) {
+        journal.owners[owner->journalId] = NULL;
+    }
     free(owner->ownerName);
     owner->ownerName = NULL;
 
-    // 3) free the trainer's Pokedex tree
-    freePokemonTree(owner->pokedexRoot);
+    // 3) free the trainer's Pokedex - every node lives in the arena, so drop its chunks at once.
+    //    The leaderboard points at those nodes, so they leave it first: one O(log N) heap removal
+    //    per Pokemon, i.e. O(n log N) for deleting an owner with n Pokemon(a merge empties owner2's
+    //    tree before this, and freeAllOwners clears the heap first, so neither pays it)
+    if(leaderboard.count > 0 && owner->pokedexRoot != NULL) {
+        reserveNodeArray(&scratchNodes, owner->stats.pokemonCount);
+        scratchNodes.size = 0;
+        collectAll(owner->pokedexRoot, &scratchNodes);
+        for(int i = 0; i < scratchNodes.size; i++) {
+            leaderboardRemove(scratchNodes.nodes[i]);
+        }
+        scratchNodes.size = 0;
+    }
+    releasePokemonArena(&owner->arena);
+    owner->pokedexRoot = NULL;
 
     // 4) free the node itself
     free(owner);
@@ -1014,6 +2880,9 @@ void freeAllOwners() {
         return;
     }
 
+    //the whole leaderboard goes at once, so freeing the nodes doesn't sift it one by one
+    leaderboardClear();
+
     // 2) go over every element of the list and free its contents - until the head pointer is reached
     OwnerNode* currentNode = ownerHead;
     OwnerNode* traversionNode = NULL;
@@ -1032,6 +2901,8 @@ void freeAllOwners() {
 
     //avoid dangling head pointer
     ownerHead = NULL;
+    ownerIndexClear();
+    registryClear();
 }
 
 // --------------------------------------------------------------
@@ -1040,6 +2911,9 @@ void freeAllOwners() {
 
 // Function to remove a target owner from the linked list of owners
 void removeOwnerFromCircularList(OwnerNode **target) {
+    ownerIndexRemove(*target);
+    registryRemove(*target);
+
     //the list is circular, so checking either next or prev's existence is enough
     if((*target)->next != NULL) {
         (*target)->next->prev = (*target)->prev;
@@ -1076,9 +2950,8 @@ void deletePokedex() {
     printAllOwners();
     int pokedexToDelete = readIntSafe("Choose a Pokedex to delete by number: ");
     OwnerNode* nodeToDelete = findOwnerByPosition(pokedexToDelete - 1);
-    OwnerNode** nodePointer = &nodeToDelete;
     printf("Deleting %s's entire Pokedex...\nPokedex deleted.\n", nodeToDelete->ownerName);
-    removeOwnerFromCircularList(nodePointer);
+    deleteOwnerCore(nodeToDelete);
     nodeToDelete = NULL;
 }
 
@@ -1092,86 +2965,250 @@ void mergePokedexMenu() {
         return;
     }
 
-    //get the owner names from the user
+    //get the owner names from the user and look them up right away(the names are only views)
     printf("\n=== Merge Pokedexes ===\nEnter name of first owner: ");
-    char* name1 = getDynamicInput();
+    OwnerNode* owner1 = findOwnerByName(readInputLine());
     printf("Enter name of second owner: ");
-    char* name2 = getDynamicInput();
-
-    //try to find both owners in the list(by name)
-    OwnerNode* owner1 = findOwnerByName(name1);
-    OwnerNode* owner2 = findOwnerByName(name2);
+    OwnerNode* owner2 = findOwnerByName(readInputLine());
 
     //if owners were'nt found in the list
     if(owner1 == NULL || owner2 == NULL) {
         printf("One or both owners not found.\n");
-        free(name1);
-        free(name2);
         return;
     }
 
-    //merge the 2nd owner into the 1st
-    printf("Merging %s and %s...\n", name1, name2);
+    //merging an owner into themselves would delete them
+    if(owner1 == owner2) {
+        printf("Cannot merge an owner with themselves.\n");
+        return;
+    }
+
+    //merge the 2nd owner into the 1st(its name goes with it, so keep a copy for the message)
+    printf("Merging %s and %s...\n", owner1->ownerName, owner2->ownerName);
+    char* removedName = myStrdup(owner2->ownerName);
+    OpStatus status = mergeOwnersCore(owner1, owner2);
+    if(status != OP_OK) {
+        printf("%s\n", opStatusMessage(status));
+    }
+    else {
+        printf("Merge completed.\nOwner '%s' has been removed after merging.\n", removedName);
+    }
+    free(removedName);
+}
+
+// Function to merge the second owner into the first and remove it without printing anything
+OpStatus mergeOwnersCore(OwnerNode *owner1, OwnerNode *owner2) {
+    if(owner1 == owner2) {
+        return OP_SAME_OWNER;
+    }
+    journalOwnerOp(JOURNAL_MERGE, owner1, 0, (uint32_t)owner2->journalId);
     mergePokedexes(owner1, owner2);
 
     //prevent the merged Pokemon from being freed accidentally
     owner2->pokedexRoot = NULL;
     //delete the 2nd owner
     removeOwnerFromCircularList(&owner2);
-    printf("Merge completed.\nOwner '%s' has been removed after merging.\n", name2);
+    return OP_OK;
+}
 
-    free(name1);
-    free(name2);
+// Function to remove an owner without printing anything
+void deleteOwnerCore(OwnerNode *owner) {
+    journalOwnerOp(JOURNAL_DELETE, owner, 0, 0);
+    removeOwnerFromCircularList(&owner);
+}
+
+// Function to hash an owner's name(FNV-1a)
+uint32_t hashOwnerName(const char *name) {
+    uint32_t hash = 2166136261u;
+    while(*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Function to place an entry in the first free slot of its probe sequence
+void ownerIndexPlace(OwnerIndexEntry *entries, int capacity, OwnerIndexEntry entry) {
+    int mask = capacity - 1;
+    int i = (int)(entry.hash & (uint32_t)mask);
+    while(entries[i].owner != NULL) {
+        i = (i + 1) & mask;
+    }
+    entries[i] = entry;
+}
+
+// Function to add an owner to the by-name index
+void ownerIndexInsert(OwnerNode *owner) {
+    // 1) keep the table at most half full - double it (and re-place everything) if needed
+    if((ownerIndex.count + 1) * 2 > ownerIndex.capacity) {
+        int newCapacity = ownerIndex.capacity == 0 ? OWNER_INDEX_MIN_CAPACITY : ownerIndex.capacity * 2;
+        OwnerIndexEntry* newEntries = (OwnerIndexEntry *)calloc(newCapacity, sizeof(OwnerIndexEntry));
+        if(newEntries == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        for(int i = 0; i < ownerIndex.capacity; i++) {
+            if(ownerIndex.entries[i].owner != NULL) {
+                ownerIndexPlace(newEntries, newCapacity, ownerIndex.entries[i]);
+            }
+        }
+        free(ownerIndex.entries);
+        ownerIndex.entries = newEntries;
+        ownerIndex.capacity = newCapacity;
+    }
+
+    // 2) place the new owner
+    OwnerIndexEntry entry;
+    entry.hash = hashOwnerName(owner->ownerName);
+    entry.owner = owner;
+    ownerIndexPlace(ownerIndex.entries, ownerIndex.capacity, entry);
+    ownerIndex.count++;
+}
+
+// Function to remove an owner from the by-name index
+void ownerIndexRemove(OwnerNode *owner) {
+    if(ownerIndex.count == 0) {
+        return;
+    }
+
+    // 1) find the owner's slot
+    int mask = ownerIndex.capacity - 1;
+    int i = (int)(hashOwnerName(owner->ownerName) & (uint32_t)mask);
+    while(ownerIndex.entries[i].owner != owner) {
+        if(ownerIndex.entries[i].owner == NULL) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // 2) backward-shift deletion: pull later entries of the cluster into the hole
+    //    whenever the hole lies on their probe path, so lookups never need tombstones
+    int hole = i;
+    int j = i;
+    while(1) {
+        j = (j + 1) & mask;
+        if(ownerIndex.entries[j].owner == NULL) {
+            break;
+        }
+        int home = (int)(ownerIndex.entries[j].hash & (uint32_t)mask);
+        if(((j - home) & mask) >= ((j - hole) & mask)) {
+            ownerIndex.entries[hole] = ownerIndex.entries[j];
+            hole = j;
+        }
+    }
+    ownerIndex.entries[hole].owner = NULL;
+    ownerIndex.count--;
+}
+
+// Function to drop the whole by-name index
+void ownerIndexClear() {
+    free(ownerIndex.entries);
+    ownerIndex.entries = NULL;
+    ownerIndex.capacity = 0;
+    ownerIndex.count = 0;
 }
 
 // Function to find an owner by their given name
 OwnerNode *findOwnerByName(const char *name) {
-    if(ownerHead == NULL) {
+    if(ownerIndex.count == 0) {
         return NULL;
     }
 
-    OwnerNode* currentNode = ownerHead;
-
-    //go over the rest of the list and compare the names to the given name
-     do {
-        if(strcmp(currentNode->ownerName, name) == 0) {
-            return currentNode;
-        }
-        if(currentNode->next != NULL) {
-            currentNode = currentNode->next;
+    //probe from the name's home slot until the name or an empty slot is found
+    uint32_t hash = hashOwnerName(name);
+    int mask = ownerIndex.capacity - 1;
+    int i = (int)(hash & (uint32_t)mask);
+    while(ownerIndex.entries[i].owner != NULL) {
+        if(ownerIndex.entries[i].hash == hash && strcmp(ownerIndex.entries[i].owner->ownerName, name) == 0) {
+            return ownerIndex.entries[i].owner;
         }
-    } while(currentNode != ownerHead);
+        i = (i + 1) & mask;
+    }
 
     return NULL;
 }
 
-// Function merge an owner into another owner(2->1) using BFS
+// Function merge an owner into another owner(2->1) in linear time:
+// flatten both trees in-order, merge the sorted arrays, rebuild one balanced tree
 void mergePokedexes(OwnerNode* owner1, OwnerNode* owner2) {
-    if(owner1 == NULL || owner2 == NULL) {
+    if(owner1 == NULL || owner2 == NULL || owner1 == owner2) {
         return;
     }
 
-    //init node array to use for BFS order
-    NodeArray* nodeArray = malloc(sizeof(NodeArray));
-    if(nodeArray == NULL) {
-        printf("Memory allocation error.\n");
-        exit(1);
+    //word-wise AND-NOT: which of owner2's IDs are new to owner1
+    uint64_t newBits[POKEDEX_WORDS];
+    uint64_t anyNew = 0;
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        newBits[w] = owner2->pokedexBits[w] & ~owner1->pokedexBits[w];
+        anyNew |= newBits[w];
     }
-    initNodeArray(nodeArray, 1);
 
-    //insert all of owner2's Pokemon into the node array
-    collectAll(owner2->pokedexRoot, nodeArray);
+    //nothing new - owner2's nodes are all duplicates, so they're simply released
+    if(anyNew == 0) {
+        freePokemonTree(&owner2->arena, owner2->pokedexRoot);
+        owner2->pokedexRoot = NULL;
+        memset(owner2->pokedexBits, 0, sizeof(owner2->pokedexBits));
+        memset(&owner2->stats, 0, sizeof(owner2->stats));
+        return;
+    }
 
-    //go over all of the node array's nodes and insert them one by one to owner1's Pokedex tree
-    for(int i = 0; i < nodeArray->size; i++) {
-        //if the pokemon is not already found in the Pokedex - insert it
-        if(searchPokemonBFS(owner1->pokedexRoot, nodeArray->nodes[i]->data->id) == NULL) {
-            insertPokemonNode(owner1->pokedexRoot, nodeArray->nodes[i]);
+    //owner2's nodes are moving into owner1's tree, so their memory moves with them
+    adoptPokemonArena(&owner1->arena, &owner2->arena);
+
+    // 1) flatten both trees in-order into the scratch buffer - the counts give the exact sizes.
+    //    Layout: [merged output (size1 + size2) | second (size2)], with first placed at the
+    //    tail of the output area. The merge writes at i + j - duplicates <= size2 + i, so it
+    //    never overwrites a node of first before reading it.
+    int size1 = countOwnedPokemon(owner1);
+    int size2 = countOwnedPokemon(owner2);
+    reserveNodeArray(&scratchNodes, size1 + 2 * size2);
+    NodeArray merged = {scratchNodes.nodes, 0, size1 + size2};
+    NodeArray first = {scratchNodes.nodes + size2, 0, size1};
+    NodeArray second = {scratchNodes.nodes + size1 + size2, 0, size2};
+    flattenInOrder(owner1->pokedexRoot, &first);
+    flattenInOrder(owner2->pokedexRoot, &second);
+
+    // 2) one linear merge pass by ID - a duplicate keeps owner1's node and frees owner2's
+    int i = 0;
+    int j = 0;
+    while(i < first.size && j < second.size) {
+        int id1 = first.nodes[i]->data->id;
+        int id2 = second.nodes[j]->data->id;
+        if(id1 < id2) {
+            merged.nodes[merged.size++] = first.nodes[i++];
+        }
+        else if(id2 < id1) {
+            leaderboardSetOwner(second.nodes[j], owner1);
+            merged.nodes[merged.size++] = second.nodes[j++];
         }
+        else {
+            merged.nodes[merged.size++] = first.nodes[i++];
+            freePokemonNode(&owner1->arena, second.nodes[j++]);
+        }
+    }
+    while(i < first.size) {
+        merged.nodes[merged.size++] = first.nodes[i++];
     }
+    while(j < second.size) {
+        leaderboardSetOwner(second.nodes[j], owner1);
+        merged.nodes[merged.size++] = second.nodes[j++];
+    }
+
+    // 3) rebuild owner1's tree perfectly balanced from the sorted nodes
+    owner1->pokedexRoot = buildBalancedTree(merged.nodes, merged.size);
+    owner2->pokedexRoot = NULL;
 
-    free(nodeArray->nodes);
-    free(nodeArray);
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        owner1->pokedexBits[w] |= newBits[w];
+        owner2->pokedexBits[w] = 0;
+    }
+    //only the newly brought-in IDs change owner1's aggregates
+    for(int w = 0; w < POKEDEX_WORDS; w++) {
+        for(uint64_t bits = newBits[w]; bits != 0; bits &= bits - 1) {
+            statsAddSpecies(&owner1->stats, w * 64 + lowestSetBit(bits) + 1);
+        }
+    }
+    memset(&owner2->stats, 0, sizeof(owner2->stats));
 }
 
 // --------------------------------------------------------------
@@ -1183,34 +3220,92 @@ void sortOwners() {
         printf("0 or 1 owners only => no need to sort.\n");
         return;
     }
+    sortOwnersCore();
+    printf("Owners sorted by name.\n");
+}
+
+// Function to sort the owners by name without printing anything
+void sortOwnersCore() {
+    if(ownerHead == NULL || ownerHead->next == NULL) {
+        return;
+    }
 
-    //bubble sort like algorithm
-    OwnerNode* iNode = ownerHead;
-    do {
-        OwnerNode* jNode = ownerHead;
-        do {
-            if(strcmp(iNode->ownerName, jNode->ownerName) < 0) {
-                swapOwnerNodesData(iNode, jNode);
-            }
-            jNode = jNode->next;
-        } while(jNode != ownerHead);
-        iNode = iNode->next;
-    } while(iNode != ownerHead);
+    // 1) break the ring into a NULL-terminated list
+    ownerHead->prev->next = NULL;
 
-    printf("Owners sorted by name.\n");
+    // 2) sort it by relinking the nodes
+    ownerHead = mergeSortOwnerList(ownerHead);
+
+    // 3) walk the sorted list to restore the prev pointers, then close the ring again
+    OwnerNode* tail = ownerHead;
+    while(tail->next != NULL) {
+        tail->next->prev = tail;
+        tail = tail->next;
+    }
+    tail->next = ownerHead;
+    ownerHead->prev = tail;
+
+    // 4) the positions changed - rebuild the registry in the new ring order
+    registryRebuild(ownerRegistry.capacity);
+    journalAppend(JOURNAL_SORT, 0, 0, 0);
+}
+
+// Function to merge two sorted owner lists into one
+OwnerNode *mergeOwnerLists(OwnerNode *a, OwnerNode *b) {
+    OwnerNode mergedHead;
+    OwnerNode* mergedTail = &mergedHead;
+
+    //always take the smaller name, 'a' on ties - that keeps the sort stable
+    while(a != NULL && b != NULL) {
+        if(strcmp(b->ownerName, a->ownerName) < 0) {
+            mergedTail->next = b;
+            b = b->next;
+        }
+        else {
+            mergedTail->next = a;
+            a = a->next;
+        }
+        mergedTail = mergedTail->next;
+    }
+    mergedTail->next = (a != NULL) ? a : b;
+
+    return mergedHead.next;
 }
 
-// Function to swap the locations of the two given linked list owner nodes
-void swapOwnerNodesData(OwnerNode* owner1, OwnerNode* owner2) {
-    //swap the names
-    char* tempName = owner1->ownerName;
-    owner1->ownerName = owner2->ownerName;
-    owner2->ownerName = tempName;
+// Function to merge sort a NULL-terminated owner list(bottom-up, no splitting walks)
+OwnerNode *mergeSortOwnerList(OwnerNode *head) {
+    //pending[level] holds a sorted run of 2^level nodes (or NULL), like the digits of a binary counter
+    OwnerNode* pending[OWNER_SORT_LEVELS] = {NULL};
+    int levels = 0;
+
+    // 1) take the nodes one by one and carry equal-sized runs upwards by merging them
+    while(head != NULL) {
+        OwnerNode* run = head;
+        head = head->next;
+        run->next = NULL;
+
+        int level = 0;
+        while(pending[level] != NULL) {
+            //the pending run holds older nodes, so it goes first to keep the sort stable
+            run = mergeOwnerLists(pending[level], run);
+            pending[level] = NULL;
+            level++;
+        }
+        pending[level] = run;
+        if(level + 1 > levels) {
+            levels = level + 1;
+        }
+    }
+
+    // 2) merge what's left, smallest(newest) runs first
+    OwnerNode* sorted = NULL;
+    for(int level = 0; level < levels; level++) {
+        if(pending[level] != NULL) {
+            sorted = (sorted == NULL) ? pending[level] : mergeOwnerLists(pending[level], sorted);
+        }
+    }
 
-    //swap the PokemonData
-    PokemonNode* tempTree = owner1->pokedexRoot;
-    owner1->pokedexRoot = owner2->pokedexRoot;
-    owner2->pokedexRoot = tempTree;
+    return sorted;
 }
 
 // --------------------------------------------------------------
@@ -1224,15 +3319,15 @@ void printOwnersCircular() {
 
     //get direction from the user
     printf("Enter direction (F or B): ");
-    char* direction = getDynamicInput();
+    char* direction = readInputLine();
 
     //check validity of the direction and get input again if needed
     while(checkDirection(direction) == 0) {
         printf("Invalid direction, must be L or R.\n");
         printf("Enter direction (F or B): ");
-        free(direction);
-        direction = getDynamicInput();
+        direction = readInputLine();
     }
+    int forward = (checkDirection(direction) == 1);
 
     //get number of prints from the user
     int numberOfPrints = readIntSafe("How many prints? ");
@@ -1240,41 +3335,28 @@ void printOwnersCircular() {
     //if there is only one node
     if(ownerHead->next == NULL) {
         for(int i = 0; i < numberOfPrints; i++) {
-            printf("[%d] %s\n", i, ownerHead->ownerName);
+            printOwnerRow(i, ownerHead);
         }
-        free(direction);
+        outFlush();
         return;
     }
 
+    //walk forward or backwards around the circle, one row per step
     OwnerNode* currentNode = ownerHead;
-
-    //print forward
-    if(checkDirection(direction) == 1) {
-        int i = 1;
-        while(numberOfPrints > 0 && currentNode->next != NULL) {
-            printf("[%d] %s\n", i, currentNode->ownerName);
-            numberOfPrints--;
-            i++;
-            //go to next node
-            currentNode = currentNode->next;
-        }
-        free(direction);
-        return;
+    for(int i = 1; i <= numberOfPrints; i++) {
+        printOwnerRow(i, currentNode);
+        currentNode = forward ? currentNode->next : currentNode->prev;
     }
+    outFlush();
+}
 
-    //if direction is backwards - print backwards
-    while(numberOfPrints > 0 && currentNode->prev != NULL) {
-        int i = 1;
-        while(numberOfPrints > 0 && currentNode->prev != NULL) {
-            printf("[%d] %s\n", i, currentNode->ownerName);
-            numberOfPrints--;
-            i++;
-            //go to prev node
-            currentNode = currentNode->prev;
-        }
-        free(direction);
-        return;
-    }
+// Function to print one "[i] name" row of the circular owner printing
+void printOwnerRow(int index, const OwnerNode *owner) {
+    outWrite("[", 1);
+    outInt(index);
+    outWrite("] ", 2);
+    outString(owner->ownerName);
+    outWrite("\n", 1);
 }
 
 // Function to simultaneously check validity and orientation of a given direction character input
@@ -1305,6 +3387,12 @@ void mainMenu()
         printf("5. Sort Owners by Name\n");
         printf("6. Print Owners in a direction X times\n");
         printf("7. Exit\n");
+        printf("8. Fight Everyone (all owners)\n");
+        printf("9. Top Pokemon (all owners)\n");
+        printf("10. Owner Leaderboard\n");
+        printf("11. Save Snapshot\n");
+        printf("12. Load Snapshot\n");
+        printf("13. Compact Journal\n");
         choice = readIntSafe("Your choice: ");
 
         switch (choice)
@@ -1330,15 +3418,1369 @@ void mainMenu()
         case 7:
             printf("Goodbye!\n");
             break;
+        case 8:
+            fightAllOwners();
+            break;
+        case 9:
+            displayTopPokemon();
+            break;
+        case 10:
+            displayOwnerLeaderboard();
+            break;
+        case 11:
+            snapshotMenu(1);
+            break;
+        case 12:
+            snapshotMenu(0);
+            break;
+        case 13:
+            compactJournalMenu();
+            break;
         default:
             printf("Invalid.\n");
         }
     } while (choice != 7);
 }
 
-int main()
-{
-    mainMenu();
+// --------------------------------------------------------------
+// Batch Mode
+// --------------------------------------------------------------
+
+// Function to get the message of a failed operation
+const char *opStatusMessage(OpStatus status) {
+    switch(status) {
+        case OP_INVALID_ID:
+            return "Invalid ID.";
+        case OP_INVALID_CHOICE:
+            return "Invalid choice.";
+        case OP_NAME_TAKEN:
+            return "Owner already exists.";
+        case OP_NO_OWNER:
+            return "Owner not found.";
+        case OP_EMPTY:
+            return "Pokedex empty.";
+        case OP_ALREADY_OWNED:
+            return "Pokemon already in the Pokedex.";
+        case OP_NOT_OWNED:
+            return "Pokemon not found.";
+        case OP_CANNOT_EVOLVE:
+            return "Pokemon cannot evolve.";
+        case OP_SAME_OWNER:
+            return "Cannot merge an owner with themselves.";
+        case OP_BAD_COMMAND:
+            return "Invalid command.";
+        case OP_IO_ERROR:
+            return "Cannot access the file.";
+        case OP_BAD_SNAPSHOT:
+            return "Not a valid snapshot.";
+        case OP_NO_JOURNAL:
+            return "No journal open.";
+        case OP_BAD_JOURNAL:
+            return "Journal doesn't match the snapshot.";
+        default:
+            return "OK.";
+    }
+}
+
+// Function to split a line into words in place
+int splitBatchTokens(char *line, char **tokens) {
+    int count = 0;
+    char* cursor = line;
+    while(1) {
+        while(isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        if(*cursor == '\0') {
+            return count;
+        }
+        if(count == BATCH_MAX_TOKENS) {
+            return -1;
+        }
+        tokens[count++] = cursor;
+        while(*cursor != '\0' && !isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        if(*cursor != '\0') {
+            *cursor++ = '\0';
+        }
+    }
+}
+
+// Function to parse a whole word as an int
+int parseBatchInt(const char *token, int *value) {
+    char* end;
+    long parsed = strtol(token, &end, 10);
+    if(end == token || *end != '\0' || parsed < INT_MIN || parsed > INT_MAX) {
+        return 0;
+    }
+    *value = (int)parsed;
+    return 1;
+}
+
+// Function to run one batch command on the core operations
+OpStatus runBatchCommand(char **tokens, int count) {
+    const char* command = tokens[0];
+    int value = 0;
+
+    // 1) commands that take no owner
+    if(strcmp(command, "sort") == 0 && count == 1) {
+        //the sort relinks the list, so the image owners have to be in it
+        materializeImage();
+        sortOwnersCore();
+        return OP_OK;
+    }
+    if((strcmp(command, "save") == 0 || strcmp(command, "load") == 0) && count == 2) {
+        int owners = 0;
+        return command[0] == 's' ? saveSnapshot(tokens[1], &owners) : loadSnapshot(tokens[1], &owners);
+    }
+    if(strcmp(command, "compact") == 0 && count == 1) {
+        return compactJournal();
+    }
+    if(strcmp(command, "image") == 0 && count == 2) {
+        int owners = 0;
+        return writeRegistryImage(tokens[1], &owners);
+    }
+    if(strcmp(command, "top") == 0 && count == 2) {
+        if(!parseBatchInt(tokens[1], &value)) {
+            return OP_BAD_COMMAND;
+        }
+        //the leaderboard only knows the list
+        materializeImage();
+        printTopPokemon(value);
+        return OP_OK;
+    }
+    if(strcmp(command, "new") == 0 && count == 3) {
+        if(!parseBatchInt(tokens[2], &value)) {
+            return OP_BAD_COMMAND;
+        }
+        char* name = myStrdup(tokens[1]);
+        OpStatus status = openPokedexCore(name, value);
+        if(status != OP_OK) {
+            free(name);
+        }
+        return status;
+    }
+
+    // 2) everything else names an owner first
+    if(count < 2) {
+        return OP_BAD_COMMAND;
+    }
+
+    // 3) queries only need the owner's IDs, so image owners answer in place
+    int show = strcmp(command, "show") == 0 && count == 2;
+    int find = strcmp(command, "find") == 0 && count == 3;
+    int fight = strcmp(command, "fight") == 0 && count == 4;
+    if(show || find || fight) {
+        uint64_t bits[POKEDEX_WORDS];
+        if(readOwnerBits(tokens[1], bits) != OP_OK) {
+            return OP_NO_OWNER;
+        }
+        if(show) {
+            outString(tokens[1]);
+            outWrite(":\n", 2);
+            for(int w = 0; w < POKEDEX_WORDS; w++) {
+                for(uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                    printSpeciesRow(&pokedex[w * 64 + lowestSetBit(word)]);
+                }
+            }
+            return OP_OK;
+        }
+        int ids[2] = {0, 0};
+        for(int i = 0; i + 2 < count; i++) {
+            if(!parseBatchInt(tokens[i + 2], &ids[i])) {
+                return OP_BAD_COMMAND;
+            }
+            if(ids[i] < 1 || ids[i] > POKEDEX_SIZE || !(bits[(ids[i] - 1) / 64] & ((uint64_t)1 << ((ids[i] - 1) % 64)))) {
+                return OP_NOT_OWNED;
+            }
+        }
+        if(find) {
+            printSpeciesRow(&pokedex[ids[0] - 1]);
+        }
+        else {
+            //printFightResult uses stdio, so the rows buffered so far go out first
+            outFlush();
+            printFightResult(&pokedex[ids[0] - 1], &pokedex[ids[1] - 1]);
+        }
+        return OP_OK;
+    }
+
+    // 4) deleting an image owner just hides its record
+    if(strcmp(command, "delete") == 0 && count == 2 && findOwnerByName(tokens[1]) == NULL) {
+        long record = imageFindOwner(tokens[1]);
+        if(record < 0) {
+            return OP_NO_OWNER;
+        }
+        imageShadow((uint32_t)record);
+        return OP_OK;
+    }
+
+    // 5) the rest changes the owner - an image owner is copied into the list first
+    OwnerNode* owner = findOwnerForUpdate(tokens[1]);
+    if(owner == NULL) {
+        return OP_NO_OWNER;
+    }
+
+    if(strcmp(command, "add") == 0 && count >= 3) {
+        //any number of IDs, the first failure stops the line
+        for(int i = 2; i < count; i++) {
+            if(!parseBatchInt(tokens[i], &value)) {
+                return OP_BAD_COMMAND;
+            }
+            OpStatus status = addPokemonCore(owner, value);
+            if(status != OP_OK) {
+                return status;
+            }
+        }
+        return OP_OK;
+    }
+    if((strcmp(command, "release") == 0 || strcmp(command, "evolve") == 0) && count == 3) {
+        if(!parseBatchInt(tokens[2], &value)) {
+            return OP_BAD_COMMAND;
+        }
+        return command[0] == 'r' ? releasePokemonCore(owner, value) : evolvePokemonCore(owner, value);
+    }
+    if(strcmp(command, "merge") == 0 && count == 3) {
+        OwnerNode* owner2 = findOwnerForUpdate(tokens[2]);
+        if(owner2 == NULL) {
+            return OP_NO_OWNER;
+        }
+        return mergeOwnersCore(owner, owner2);
+    }
+    if(strcmp(command, "delete") == 0 && count == 2) {
+        deleteOwnerCore(owner);
+        return OP_OK;
+    }
+    return OP_BAD_COMMAND;
+}
+
+// Function to run a stream of commands, one per line
+void runBatch(InputReader *input) {
+    char* line;
+    char* tokens[BATCH_MAX_TOKENS];
+    long lineNumber = 0;
+    long commands = 0;
+    long failed = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // 1) run every non-empty line that isn't a # comment
+    while((line = nextInputLine(input)) != NULL) {
+        lineNumber++;
+        int count = splitBatchTokens(line, tokens);
+        if(count == 0 || tokens[0][0] == '#') {
+            continue;
+        }
+        commands++;
+        OpStatus status = count < 0 ? OP_BAD_COMMAND : runBatchCommand(tokens, count);
+        if(status != OP_OK && status != OP_EVOLUTION_OWNED) {
+            failed++;
+            outWrite("Line ", 5);
+            outInt((int)lineNumber);
+            outWrite(": ", 2);
+            outString(opStatusMessage(status));
+            outWrite("\n", 1);
+        }
+    }
+    outFlush();
+
+    // 2) report the throughput
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Batch: %ld commands (%ld failed) in %.3f s", commands, failed, seconds);
+    if(seconds > 0) {
+        printf(", %.0f commands/sec", (double)commands / seconds);
+    }
+    printf(".\n");
+}
+
+// --------------------------------------------------------------
+// Snapshots
+// --------------------------------------------------------------
+
+// Function to store a 32-bit value little-endian
+void putUint32(unsigned char *out, uint32_t value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+// Function to load a little-endian 32-bit value
+uint32_t getUint32(const unsigned char *in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Function to write every owner to a snapshot file
+OpStatus saveSnapshot(const char *path, int *savedCount) {
+    //image owners are saved too
+    materializeImage();
+    size_t size = 0;
+    unsigned char* data = buildSnapshot(&size);
+    OpStatus status = writeFileReplacing(path, data, size);
+    free(data);
+    *savedCount = (status == OP_OK) ? ownerRegistry.alive : 0;
+    return status;
+}
+
+// Function to encode every owner in the list as a snapshot
+unsigned char *buildSnapshot(size_t *snapshotSize) {
+    // 1) size it: header, names, bitsets
+    int owners = ownerRegistry.alive;
+    size_t size = SNAPSHOT_HEADER_SIZE + (size_t)owners * (4 + SNAPSHOT_BITSET_BYTES);
+    OwnerNode* owner = ownerHead;
+    for(int i = 0; i < owners; i++) {
+        size += strlen(owner->ownerName);
+        owner = owner->next;
+    }
+    unsigned char* data = malloc(size);
+    if(data == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+
+    // 2) fill it in ring order - the name table first, then the bitsets
+    memcpy(data, SNAPSHOT_MAGIC, 4);
+    data[4] = SNAPSHOT_VERSION;
+    putUint32(data + 5, (uint32_t)owners);
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+    owner = ownerHead;
+    for(int i = 0; i < owners; i++) {
+        size_t length = strlen(owner->ownerName);
+        putUint32(data + offset, (uint32_t)length);
+        memcpy(data + offset + 4, owner->ownerName, length);
+        offset += 4 + length;
+        owner = owner->next;
+    }
+    owner = ownerHead;
+    for(int i = 0; i < owners; i++) {
+        //byte b holds IDs 8b + 1 .. 8b + 8, which is byte b % 8 of word b / 8
+        for(int b = 0; b < SNAPSHOT_BITSET_BYTES; b++) {
+            data[offset++] = (unsigned char)(owner->pokedexBits[b / 8] >> (8 * (b % 8)));
+        }
+        owner = owner->next;
+    }
+    *snapshotSize = size;
+    return data;
+}
+
+// Function to write a file next to the target and rename it over, so a failed write keeps the old file
+OpStatus writeFileReplacing(const char *path, const unsigned char *data, size_t size) {
+    char* tempPath = malloc(strlen(path) + 5);
+    if(tempPath == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    strcpy(tempPath, path);
+    strcat(tempPath, ".tmp");
+    OpStatus status = OP_IO_ERROR;
+    int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd >= 0) {
+        size_t written = 0;
+        while(written < size) {
+            ssize_t result = write(fd, data + written, size - written);
+            if(result < 0 && errno == EINTR) {
+                continue;
+            }
+            if(result <= 0) {
+                break;
+            }
+            written += (size_t)result;
+        }
+        //on disk before the rename, so the new name never points at a partial file
+        int synced = written == size && fsync(fd) == 0;
+        if(close(fd) == 0 && synced && rename(tempPath, path) == 0) {
+            status = syncParentDirectory(path);
+        }
+        else {
+            unlink(tempPath);
+        }
+    }
+    free(tempPath);
+    return status;
+}
+
+// Function to fsync the directory a file is in
+OpStatus syncParentDirectory(const char *path) {
+    // 1) the directory part of the path("." without one)
+    const char* slash = strrchr(path, '/');
+    size_t length = (slash == NULL) ? 1 : (slash == path ? 1 : (size_t)(slash - path));
+    char* directory = malloc(length + 1);
+    if(directory == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    memcpy(directory, slash == NULL ? "." : path, length);
+    directory[length] = '\0';
+
+    // 2) sync it(file systems that can't sync a directory say EINVAL - nothing to do there)
+    OpStatus status = OP_IO_ERROR;
+    int fd = open(directory, O_RDONLY);
+    if(fd >= 0) {
+        if(fsync(fd) == 0 || errno == EINVAL) {
+            status = OP_OK;
+        }
+        close(fd);
+    }
+    free(directory);
+    return status;
+}
+
+// Function to read a whole file into memory
+unsigned char *readWholeFile(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // one extra byte so an empty file still gets a buffer
+    unsigned char* data = malloc((size_t)info.st_size + 1);
+    if(data == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    size_t got = 0;
+    while(got < (size_t)info.st_size) {
+        ssize_t result = read(fd, data + got, (size_t)info.st_size - got);
+        if(result < 0 && errno == EINTR) {
+            continue;
+        }
+        if(result <= 0) {
+            break;
+        }
+        got += (size_t)result;
+    }
+    close(fd);
+    if(got != (size_t)info.st_size) {
+        free(data);
+        return NULL;
+    }
+    *size = got;
+    return data;
+}
+
+// Function to create an owner out of a snapshot bitset
+OwnerNode *restoreOwner(char *ownerName, const unsigned char *bitset) {
+    OwnerNode* owner = createOwner(ownerName, NULL);
+
+    // 1) one node per set bit - the walk goes in ID order
+    reserveNodeArray(&scratchNodes, POKEDEX_SIZE);
+    int count = 0;
+    for(int b = 0; b < SNAPSHOT_BITSET_BYTES; b++) {
+        for(uint64_t bits = bitset[b]; bits != 0; bits &= bits - 1) {
+            int id = b * 8 + lowestSetBit(bits) + 1;
+            PokemonNode* node = createPokemonNode(&owner->arena, id);
+            setPokemonOwned(owner, id, 1);
+            leaderboardAppend(owner, node);
+            scratchNodes.nodes[count++] = node;
+        }
+    }
+
+    // 2) so the tree is built straight from the sorted nodes
+    owner->pokedexRoot = buildBalancedTree(scratchNodes.nodes, count);
+    return owner;
+}
+
+// Function to add every owner of a snapshot file to the list
+OpStatus loadSnapshot(const char *path, int *loadedCount) {
+    *loadedCount = 0;
+    size_t size = 0;
+    unsigned char* data = readWholeFile(path, &size);
+    if(data == NULL) {
+        return OP_IO_ERROR;
+    }
+
+    // 1) check the whole layout before touching the list
+    int valid = size >= SNAPSHOT_HEADER_SIZE && memcmp(data, SNAPSHOT_MAGIC, 4) == 0 &&
+                data[4] == SNAPSHOT_VERSION;
+    uint32_t owners = valid ? getUint32(data + 5) : 0;
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+    for(uint32_t i = 0; valid && i < owners; i++) {
+        if(size - offset < 4) {
+            valid = 0;
+            break;
+        }
+        uint32_t length = getUint32(data + offset);
+        offset += 4;
+        if(length == 0 || length > size - offset || memchr(data + offset, '\0', length) != NULL) {
+            valid = 0;
+            break;
+        }
+        offset += length;
+    }
+    size_t bitsetOffset = offset;
+    if(valid && (size - offset) / SNAPSHOT_BITSET_BYTES != owners) {
+        valid = 0;
+    }
+    if(valid && (size - offset) % SNAPSHOT_BITSET_BYTES != 0) {
+        valid = 0;
+    }
+    //IDs past POKEDEX_SIZE don't exist
+    for(uint32_t i = 0; valid && i < owners; i++) {
+        unsigned char last = data[bitsetOffset + (i + 1) * SNAPSHOT_BITSET_BYTES - 1];
+        if(last >> (POKEDEX_SIZE - 8 * (SNAPSHOT_BITSET_BYTES - 1)) != 0) {
+            valid = 0;
+        }
+    }
+    if(!valid) {
+        free(data);
+        return OP_BAD_SNAPSHOT;
+    }
+
+    // 2) add the owners in file order; a name that's taken undoes the ones added so far
+    OwnerNode** added = malloc(((size_t)owners + 1) * sizeof(OwnerNode *));
+    if(added == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    OpStatus status = OP_OK;
+    offset = SNAPSHOT_HEADER_SIZE;
+    for(uint32_t i = 0; i < owners; i++) {
+        uint32_t length = getUint32(data + offset);
+        char* name = malloc((size_t)length + 1);
+        if(name == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        memcpy(name, data + offset + 4, length);
+        name[length] = '\0';
+        offset += 4 + length;
+        if(ownerNameTaken(name)) {
+            free(name);
+            status = OP_NAME_TAKEN;
+            break;
+        }
+        added[*loadedCount] = restoreOwner(name, data + bitsetOffset + (size_t)i * SNAPSHOT_BITSET_BYTES);
+        linkOwnerInCircularList(added[(*loadedCount)++]);
+    }
+    leaderboardHeapify();
+    if(status != OP_OK) {
+        while(*loadedCount > 0) {
+            removeOwnerFromCircularList(&added[--(*loadedCount)]);
+        }
+    }
+    free(added);
+    free(data);
+
+    //the journal can't express a load, so the loaded owners go straight into a fresh snapshot
+    if(status == OP_OK && journal.fd >= 0) {
+        status = compactJournal();
+    }
+    return status;
+}
+
+// Function to prompt for a snapshot file and save or load it
+void snapshotMenu(int save) {
+    printf("Snapshot file: ");
+    const char* path = readInputLine();
+    if(*path == '\0') {
+        printf("Invalid file name.\n");
+        return;
+    }
+    int owners = 0;
+    OpStatus status = save ? saveSnapshot(path, &owners) : loadSnapshot(path, &owners);
+    if(status != OP_OK) {
+        printf("%s\n", opStatusMessage(status));
+        return;
+    }
+    printf("%s %d owner(s) %s %s.\n", save ? "Saved" : "Loaded", owners, save ? "to" : "from", path);
+}
+
+// --------------------------------------------------------------
+// Registry Image
+// --------------------------------------------------------------
+
+// Function to map a registry image and attach it(only the header is looked at)
+OpStatus mapRegistryImage(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return OP_IO_ERROR;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        close(fd);
+        return OP_IO_ERROR;
+    }
+    if(info.st_size < IMAGE_HEADER_SIZE) {
+        close(fd);
+        return OP_BAD_SNAPSHOT;
+    }
+    size_t size = (size_t)info.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    //the mapping keeps the file alive on its own
+    close(fd);
+    if(map == MAP_FAILED) {
+        return OP_IO_ERROR;
+    }
+
+    // 1) every area has to lie inside the file(64-bit math, so nothing wraps)
+    const unsigned char* base = (const unsigned char *)map;
+    uint64_t owners = getUint32(base + 8);
+    uint64_t records = getUint32(base + 12);
+    uint64_t nameIndex = getUint32(base + 16);
+    uint64_t names = getUint32(base + 20);
+    uint64_t namesSize = getUint32(base + 24);
+    if(memcmp(base, IMAGE_MAGIC, 4) != 0 || getUint32(base + 4) != IMAGE_VERSION ||
+       records + owners * IMAGE_RECORD_SIZE > size || nameIndex + owners * 4 > size ||
+       names + namesSize > size) {
+        munmap(map, size);
+        return OP_BAD_SNAPSHOT;
+    }
+
+    // 2) attach it(replacing an older one)
+    unmapRegistryImage();
+    registryImage.base = base;
+    registryImage.size = size;
+    registryImage.ownerCount = (uint32_t)owners;
+    registryImage.records = base + records;
+    registryImage.nameIndex = base + nameIndex;
+    registryImage.names = base + names;
+    registryImage.namesSize = (uint32_t)namesSize;
+    registryImage.shadowed = NULL;
+    registryImage.shadowedCount = 0;
+    return OP_OK;
+}
+
+// Function to unmap the attached image
+void unmapRegistryImage() {
+    if(registryImage.base == NULL) {
+        return;
+    }
+    munmap((void *)registryImage.base, registryImage.size);
+    free(registryImage.shadowed);
+    registryImage.base = NULL;
+    registryImage.shadowed = NULL;
+    registryImage.ownerCount = 0;
+    registryImage.shadowedCount = 0;
+}
+
+// Function to get the name of an image record(bounds-checked, the file isn't trusted)
+const char *imageOwnerName(uint32_t record, uint32_t *length) {
+    const unsigned char* entry = registryImage.records + (size_t)record * IMAGE_RECORD_SIZE;
+    uint64_t offset = getUint32(entry);
+    *length = getUint32(entry + 4);
+    if(offset + *length > registryImage.namesSize) {
+        return NULL;
+    }
+    return (const char *)registryImage.names + offset;
+}
+
+// Function to find an owner in the image by binary search over the name index
+long imageFindOwner(const char *name) {
+    if(registryImage.base == NULL) {
+        return -1;
+    }
+    size_t nameLength = strlen(name);
+    uint32_t low = 0;
+    uint32_t high = registryImage.ownerCount;
+    while(low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        uint32_t record = getUint32(registryImage.nameIndex + (size_t)middle * 4);
+        uint32_t length = 0;
+        const char* recordName = record < registryImage.ownerCount ? imageOwnerName(record, &length) : NULL;
+        if(recordName == NULL) {
+            return -1;
+        }
+
+        //bytewise, the shorter name first on a tie - the order the writer sorted by
+        int compare = memcmp(name, recordName, nameLength < length ? nameLength : length);
+        if(compare == 0) {
+            compare = (nameLength > length) - (nameLength < length);
+        }
+        if(compare == 0) {
+            return imageIsShadowed(record) ? -1 : (long)record;
+        }
+        if(compare < 0) {
+            high = middle;
+        }
+        else {
+            low = middle + 1;
+        }
+    }
+    return -1;
+}
+
+// Function to check if a record was copied out or deleted
+int imageIsShadowed(uint32_t record) {
+    return registryImage.shadowed != NULL && (registryImage.shadowed[record / 8] >> (record % 8)) & 1;
+}
+
+// Function to mark a record as copied out or deleted
+void imageShadow(uint32_t record) {
+    if(registryImage.shadowed == NULL) {
+        registryImage.shadowed = calloc((size_t)registryImage.ownerCount / 8 + 1, 1);
+        if(registryImage.shadowed == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+    }
+    if(!imageIsShadowed(record)) {
+        registryImage.shadowed[record / 8] |= (unsigned char)(1 << (record % 8));
+        registryImage.shadowedCount++;
+    }
+}
+
+// Function to expand an image record's bitset into pokedexBits words
+void imageOwnerBits(uint32_t record, uint64_t bits[POKEDEX_WORDS]) {
+    const unsigned char* bitset = registryImage.records + (size_t)record * IMAGE_RECORD_SIZE + IMAGE_RECORD_BITSET;
+    memset(bits, 0, POKEDEX_WORDS * sizeof(uint64_t));
+    for(int b = 0; b < SNAPSHOT_BITSET_BYTES; b++) {
+        bits[b / 8] |= (uint64_t)bitset[b] << (8 * (b % 8));
+    }
+    //IDs past POKEDEX_SIZE don't exist
+    bits[POKEDEX_WORDS - 1] &= ((uint64_t)1 << (POKEDEX_SIZE - 64 * (POKEDEX_WORDS - 1))) - 1;
+}
+
+// Function to check if a name is used in the list or the image
+int ownerNameTaken(const char *name) {
+    return findOwnerByName(name) != NULL || imageFindOwner(name) >= 0;
+}
+
+// Function to build a restorable copy of a record's bitset(IDs past POKEDEX_SIZE dropped)
+void imageRecordBitset(uint32_t record, unsigned char bitset[SNAPSHOT_BITSET_BYTES]) {
+    memcpy(bitset, registryImage.records + (size_t)record * IMAGE_RECORD_SIZE + IMAGE_RECORD_BITSET,
+           SNAPSHOT_BITSET_BYTES);
+    bitset[SNAPSHOT_BITSET_BYTES - 1] &= (unsigned char)((1 << (POKEDEX_SIZE - 8 * (SNAPSHOT_BITSET_BYTES - 1))) - 1);
+}
+
+// Function to copy an image record's name into its own memory
+char *imageNameCopy(uint32_t record) {
+    uint32_t length = 0;
+    const char* name = imageOwnerName(record, &length);
+    char* copy = malloc((size_t)length + 1);
+    if(copy == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Function to copy one image owner into the list
+OwnerNode *materializeImageOwner(uint32_t record) {
+    unsigned char bitset[SNAPSHOT_BITSET_BYTES];
+    imageRecordBitset(record, bitset);
+
+    // 1) restoreOwner appends its Pokemon to the leaderboard unsorted - insert them one by one
+    int first = leaderboard.count;
+    OwnerNode* owner = restoreOwner(imageNameCopy(record), bitset);
+    int total = leaderboard.count;
+    leaderboard.count = first;
+    while(leaderboard.count < total) {
+        leaderboard.count++;
+        leaderboardSift(leaderboard.count - 1);
+    }
+
+    // 2) from now on the list's copy is the owner
+    linkOwnerInCircularList(owner);
+    imageShadow(record);
+    return owner;
+}
+
+// Function to copy every remaining image owner into the list
+void materializeImage() {
+    if(registryImage.base == NULL || registryImage.shadowedCount == registryImage.ownerCount) {
+        return;
+    }
+    unsigned char bitset[SNAPSHOT_BITSET_BYTES];
+    for(uint32_t record = 0; record < registryImage.ownerCount; record++) {
+        uint32_t length = 0;
+        //records with a broken name can't be looked up either - they're skipped
+        if(imageIsShadowed(record) || imageOwnerName(record, &length) == NULL) {
+            continue;
+        }
+        //a hand-made image could repeat a name - only the first one counts
+        char* name = imageNameCopy(record);
+        if(findOwnerByName(name) != NULL) {
+            free(name);
+            continue;
+        }
+        imageRecordBitset(record, bitset);
+        linkOwnerInCircularList(restoreOwner(name, bitset));
+        imageShadow(record);
+    }
+    //one bottom-up pass for everything restoreOwner appended
+    leaderboardHeapify();
+    unmapRegistryImage();
+}
+
+// Function to find an owner to change, copying it out of the image if needed
+OwnerNode *findOwnerForUpdate(const char *name) {
+    OwnerNode* owner = findOwnerByName(name);
+    if(owner != NULL) {
+        return owner;
+    }
+    long record = imageFindOwner(name);
+    return record < 0 ? NULL : materializeImageOwner((uint32_t)record);
+}
+
+// Function to get an owner's Pokedex bits from the list or the image
+OpStatus readOwnerBits(const char *name, uint64_t bits[POKEDEX_WORDS]) {
+    OwnerNode* owner = findOwnerByName(name);
+    if(owner != NULL) {
+        memcpy(bits, owner->pokedexBits, sizeof(owner->pokedexBits));
+        return OP_OK;
+    }
+    long record = imageFindOwner(name);
+    if(record < 0) {
+        return OP_NO_OWNER;
+    }
+    imageOwnerBits((uint32_t)record, bits);
+    return OP_OK;
+}
+
+// Function to compare two image name entries bytewise
+int compareImageNames(const void *a, const void *b) {
+    const ImageNameEntry* first = (const ImageNameEntry*)a;
+    const ImageNameEntry* second = (const ImageNameEntry*)b;
+    return strcmp(first->name, second->name);
+}
+
+// Function to write every owner as a registry image
+OpStatus writeRegistryImage(const char *path, int *writtenCount) {
+    materializeImage();
+
+    // 1) lay out the areas: header, records, name index, names
+    uint32_t owners = (uint32_t)ownerRegistry.alive;
+    size_t namesSize = 0;
+    OwnerNode* owner = ownerHead;
+    for(uint32_t i = 0; i < owners; i++) {
+        namesSize += strlen(owner->ownerName);
+        owner = owner->next;
+    }
+    size_t records = IMAGE_HEADER_SIZE;
+    size_t nameIndex = records + (size_t)owners * IMAGE_RECORD_SIZE;
+    size_t names = nameIndex + (size_t)owners * 4;
+    size_t size = names + namesSize;
+    if(size > UINT32_MAX) {
+        return OP_IO_ERROR;
+    }
+    unsigned char* data = calloc(size, 1);
+    ImageNameEntry* sorted = malloc(((size_t)owners + 1) * sizeof(ImageNameEntry));
+    if(data == NULL || sorted == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    memcpy(data, IMAGE_MAGIC, 4);
+    putUint32(data + 4, IMAGE_VERSION);
+    putUint32(data + 8, owners);
+    putUint32(data + 12, (uint32_t)records);
+    putUint32(data + 16, (uint32_t)nameIndex);
+    putUint32(data + 20, (uint32_t)names);
+    putUint32(data + 24, (uint32_t)namesSize);
+
+    // 2) one record per owner in ring order
+    size_t nameOffset = 0;
+    owner = ownerHead;
+    for(uint32_t i = 0; i < owners; i++) {
+        unsigned char* entry = data + records + (size_t)i * IMAGE_RECORD_SIZE;
+        size_t length = strlen(owner->ownerName);
+        putUint32(entry, (uint32_t)nameOffset);
+        putUint32(entry + 4, (uint32_t)length);
+        for(int b = 0; b < SNAPSHOT_BITSET_BYTES; b++) {
+            entry[IMAGE_RECORD_BITSET + b] = (unsigned char)(owner->pokedexBits[b / 8] >> (8 * (b % 8)));
+        }
+        entry[IMAGE_RECORD_COUNT] = (unsigned char)owner->stats.pokemonCount;
+        memcpy(data + names + nameOffset, owner->ownerName, length);
+        nameOffset += length;
+        sorted[i].name = owner->ownerName;
+        sorted[i].record = i;
+        owner = owner->next;
+    }
+
+    // 3) the name index
+    qsort(sorted, owners, sizeof(ImageNameEntry), compareImageNames);
+    for(uint32_t i = 0; i < owners; i++) {
+        putUint32(data + nameIndex + (size_t)i * 4, sorted[i].record);
+    }
+
+    OpStatus status = writeFileReplacing(path, data, size);
+    free(sorted);
+    free(data);
+    *writtenCount = (status == OP_OK) ? (int)owners : 0;
+    return status;
+}
+
+// --------------------------------------------------------------
+// Journal
+// --------------------------------------------------------------
+
+// Function to hash a byte range(FNV-1a)
+uint32_t hashBytes(const unsigned char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Function to give an owner the next journal owner ID
+void journalAssignId(OwnerNode *owner) {
+    if(journal.ownerCount == journal.ownerCapacity) {
+        uint32_t capacity = journal.ownerCapacity ? journal.ownerCapacity * 2 : 64;
+        OwnerNode** owners = realloc(journal.owners, (size_t)capacity * sizeof(OwnerNode *));
+        if(owners == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        journal.owners = owners;
+        journal.ownerCapacity = capacity;
+    }
+    journal.owners[journal.ownerCount] = owner;
+    owner->journalId = (int)journal.ownerCount++;
+}
+
+// Function to number the owners in list order, the order a snapshot stores them in
+void journalResetIds() {
+    journal.ownerCount = 0;
+    OwnerNode* owner = ownerHead;
+    for(int i = 0; i < ownerRegistry.alive; i++) {
+        journalAssignId(owner);
+        owner = owner->next;
+    }
+}
+
+// Function to queue one journal record
+void journalAppend(JournalOp op, uint16_t small, uint32_t owner, uint32_t argument) {
+    if(journal.fd < 0) {
+        return;
+    }
+    unsigned char* record = journal.batch + (size_t)journal.batched * JOURNAL_RECORD_SIZE;
+    record[0] = (unsigned char)op;
+    record[1] = 0;
+    record[2] = (unsigned char)small;
+    record[3] = (unsigned char)(small >> 8);
+    putUint32(record + 4, owner);
+    putUint32(record + 8, argument);
+    putUint32(record + 12, hashBytes(record, 12));
+    if(++journal.batched == JOURNAL_BATCH_RECORDS) {
+        journalFlush();
+    }
+}
+
+// Function to log a change to an owner
+void journalOwnerOp(JournalOp op, const OwnerNode *owner, uint16_t small, uint32_t argument) {
+    if(journal.fd < 0) {
+        return;
+    }
+    journalAppend(op, small, (uint32_t)owner->journalId, argument);
+}
+
+// Function to number a new owner and log it with its name
+void journalNewOwner(OwnerNode *owner, int starterChoice) {
+    //replay numbers the owners it creates too
+    if(journal.snapshotPath == NULL) {
+        return;
+    }
+    journalAssignId(owner);
+    if(journal.fd < 0) {
+        return;
+    }
+
+    //the name goes 8 bytes per record, in the owner and argument fields
+    size_t length = strlen(owner->ownerName);
+    journalAppend(JOURNAL_NEW, (uint16_t)starterChoice, (uint32_t)owner->journalId, (uint32_t)length);
+    for(size_t i = 0; i < length; i += JOURNAL_NAME_BYTES) {
+        unsigned char bytes[JOURNAL_NAME_BYTES] = {0};
+        size_t used = (length - i < JOURNAL_NAME_BYTES) ? length - i : JOURNAL_NAME_BYTES;
+        memcpy(bytes, owner->ownerName + i, used);
+        journalAppend(JOURNAL_NAME, (uint16_t)used, getUint32(bytes), getUint32(bytes + 4));
+    }
+}
+
+// Function to write and fsync the batched journal records
+void journalFlush() {
+    if(journal.fd < 0 || journal.batched == 0) {
+        return;
+    }
+    size_t size = (size_t)journal.batched * JOURNAL_RECORD_SIZE;
+    size_t written = 0;
+    while(written < size) {
+        ssize_t result = write(journal.fd, journal.batch + written, size - written);
+        if(result < 0 && errno == EINTR) {
+            continue;
+        }
+        if(result <= 0) {
+            break;
+        }
+        written += (size_t)result;
+    }
+    if(written != size || fsync(journal.fd) != 0) {
+        printf("Cannot write the journal.\n");
+    }
+    journal.batched = 0;
+}
+
+// Function to apply one journal operation(a new owner with its name records)
+size_t replayJournalRecord(const unsigned char *record, size_t available) {
+    unsigned int small = (unsigned int)record[2] | ((unsigned int)record[3] << 8);
+    uint32_t id = getUint32(record + 4);
+    uint32_t argument = getUint32(record + 8);
+
+    // 1) a new owner: it has to get the next ID, and its name records have to follow it
+    if(record[0] == JOURNAL_NEW) {
+        size_t nameRecords = ((size_t)argument + JOURNAL_NAME_BYTES - 1) / JOURNAL_NAME_BYTES;
+        if(id != journal.ownerCount || argument == 0 || nameRecords >= available / JOURNAL_RECORD_SIZE) {
+            return 0;
+        }
+        char* name = malloc((size_t)argument + 1);
+        if(name == NULL) {
+            printf("Memory allocation failed.\n");
+            exit(1);
+        }
+        for(size_t i = 0; i < nameRecords; i++) {
+            const unsigned char* part = record + (i + 1) * JOURNAL_RECORD_SIZE;
+            size_t used = argument - i * JOURNAL_NAME_BYTES;
+            used = (used < JOURNAL_NAME_BYTES) ? used : JOURNAL_NAME_BYTES;
+            if(part[0] != JOURNAL_NAME || part[2] != used || part[3] != 0) {
+                free(name);
+                return 0;
+            }
+            memcpy(name + i * JOURNAL_NAME_BYTES, part + 4, used);
+        }
+        name[argument] = '\0';
+        if(strlen(name) != argument || openPokedexCore(name, (int)small) != OP_OK) {
+            free(name);
+            return 0;
+        }
+        return (nameRecords + 1) * JOURNAL_RECORD_SIZE;
+    }
+    if(record[0] == JOURNAL_SORT) {
+        sortOwnersCore();
+        return JOURNAL_RECORD_SIZE;
+    }
+
+    // 2) the rest change an owner that still exists, and only ever logged what succeeded
+    if(id >= journal.ownerCount || journal.owners[id] == NULL) {
+        return 0;
+    }
+    OwnerNode* owner = journal.owners[id];
+    OpStatus status = OP_BAD_COMMAND;
+    switch(record[0]) {
+        case JOURNAL_ADD:
+            status = addPokemonCore(owner, (int)argument);
+            break;
+        case JOURNAL_RELEASE:
+            status = releasePokemonCore(owner, (int)argument);
+            break;
+        case JOURNAL_RELEASE_RANGE:
+            if(argument >= 1 && argument <= small && small <= POKEDEX_SIZE &&
+               releasePokemonRangeCore(owner, (int)argument, (int)small) > 0) {
+                status = OP_OK;
+            }
+            break;
+        case JOURNAL_EVOLVE:
+            status = evolvePokemonCore(owner, (int)argument);
+            if(status == OP_EVOLUTION_OWNED) {
+                status = OP_OK;
+            }
+            break;
+        case JOURNAL_MERGE:
+            if(argument < journal.ownerCount && journal.owners[argument] != NULL) {
+                status = mergeOwnersCore(owner, journal.owners[argument]);
+            }
+            break;
+        case JOURNAL_DELETE:
+            deleteOwnerCore(owner);
+            status = OP_OK;
+            break;
+        default:
+            break;
+    }
+    return (status == OP_OK) ? JOURNAL_RECORD_SIZE : 0;
+}
+
+// Function to check a journal record's checksum
+int journalRecordIntact(const unsigned char *record) {
+    return record[1] == 0 && getUint32(record + 12) == hashBytes(record, 12);
+}
+
+// Function to apply journal records on top of the loaded snapshot
+OpStatus replayJournal(const unsigned char *data, size_t size, size_t *applied) {
+    // 1) the intact part: whole records with good checksums - a crash mid-write can only
+    //    leave a short or garbled tail
+    size_t intact = 0;
+    while(size - intact >= JOURNAL_RECORD_SIZE && journalRecordIntact(data + intact)) {
+        intact += JOURNAL_RECORD_SIZE;
+    }
+
+    //that tail is at most the last flush, one batch - an intact record further on means the
+    //damage is somewhere in the middle, and cutting there would throw good records away
+    *applied = 0;
+    size_t tailLimit = intact + (size_t)JOURNAL_BATCH_RECORDS * JOURNAL_RECORD_SIZE;
+    for(size_t later = tailLimit; later < size && size - later >= JOURNAL_RECORD_SIZE; later += JOURNAL_RECORD_SIZE) {
+        if(journalRecordIntact(data + later)) {
+            return OP_BAD_JOURNAL;
+        }
+    }
+
+    // 2) apply it; an intact record that doesn't apply means the journal and the state disagree
+    size_t offset = 0;
+    while(offset < intact) {
+        const unsigned char* record = data + offset;
+        //a new owner whose name records were torn off goes with the tail
+        size_t nameRecords = ((size_t)getUint32(record + 8) + JOURNAL_NAME_BYTES - 1) / JOURNAL_NAME_BYTES;
+        if(record[0] == JOURNAL_NEW && nameRecords >= (intact - offset) / JOURNAL_RECORD_SIZE) {
+            break;
+        }
+        size_t used = replayJournalRecord(record, intact - offset);
+        if(used == 0) {
+            *applied = offset;
+            return OP_BAD_JOURNAL;
+        }
+        offset += used;
+    }
+    *applied = offset;
+    return OP_OK;
+}
+
+// Function to start a journal holding only the header, and open it for appending
+OpStatus startJournalFile(uint32_t snapshotSize, uint32_t snapshotHash) {
+    unsigned char header[JOURNAL_HEADER_SIZE];
+    memcpy(header, JOURNAL_MAGIC, 4);
+    putUint32(header + 4, JOURNAL_VERSION);
+    putUint32(header + 8, snapshotSize);
+    putUint32(header + 12, snapshotHash);
+    if(writeFileReplacing(journal.journalPath, header, JOURNAL_HEADER_SIZE) != OP_OK) {
+        return OP_IO_ERROR;
+    }
+    int fd = open(journal.journalPath, O_WRONLY | O_APPEND);
+    if(fd < 0) {
+        return OP_IO_ERROR;
+    }
+    if(journal.fd >= 0) {
+        close(journal.fd);
+    }
+    journal.fd = fd;
+    journal.batched = 0;
+    return OP_OK;
+}
+
+// Function to make a path out of the journal base and a suffix
+char *journalFilePath(const char *base, const char *suffix) {
+    char* path = malloc(strlen(base) + strlen(suffix) + 1);
+    if(path == NULL) {
+        printf("Memory allocation failed.\n");
+        exit(1);
+    }
+    strcpy(path, base);
+    strcat(path, suffix);
+    return path;
+}
+
+// Function to load the journal's snapshot, replay the journal and keep appending to it
+OpStatus openJournal(const char *base) {
+    journal.snapshotPath = journalFilePath(base, ".snap");
+    journal.journalPath = journalFilePath(base, ".journal");
+
+    // 1) the snapshot(none yet is an empty one)
+    size_t snapshotSize = 0;
+    unsigned char* snapshot = readWholeFile(journal.snapshotPath, &snapshotSize);
+    if(snapshot == NULL && access(journal.snapshotPath, F_OK) == 0) {
+        return OP_IO_ERROR;
+    }
+    uint32_t snapshotHash = hashBytes(snapshot, snapshotSize);
+    if(snapshot != NULL) {
+        free(snapshot);
+        int owners = 0;
+        OpStatus status = loadSnapshot(journal.snapshotPath, &owners);
+        if(status != OP_OK) {
+            return status;
+        }
+    }
+    journalResetIds();
+
+    // 2) replay the journal if it continues this snapshot - one left over from before a
+    //    compaction finished is already in it
+    size_t size = 0;
+    unsigned char* data = readWholeFile(journal.journalPath, &size);
+    if(data != NULL && size >= JOURNAL_HEADER_SIZE && memcmp(data, JOURNAL_MAGIC, 4) == 0 &&
+       getUint32(data + 4) == JOURNAL_VERSION && getUint32(data + 8) == (uint32_t)snapshotSize &&
+       getUint32(data + 12) == snapshotHash) {
+        size_t applied = 0;
+        OpStatus status = replayJournal(data + JOURNAL_HEADER_SIZE, size - JOURNAL_HEADER_SIZE, &applied);
+        free(data);
+        if(status != OP_OK) {
+            return status;
+        }
+
+        // 3) cut off a torn tail so new records follow the last good one
+        int fd = open(journal.journalPath, O_WRONLY | O_APPEND);
+        if(fd < 0) {
+            return OP_IO_ERROR;
+        }
+        size_t dropped = size - JOURNAL_HEADER_SIZE - applied;
+        if(dropped > 0) {
+            if(ftruncate(fd, (off_t)(JOURNAL_HEADER_SIZE + applied)) != 0 || fsync(fd) != 0) {
+                close(fd);
+                return OP_IO_ERROR;
+            }
+            printf("Journal %s: dropped a torn tail of %lu byte(s).\n", journal.journalPath, (unsigned long)dropped);
+        }
+        journal.fd = fd;
+        return OP_OK;
+    }
+    free(data);
+    return startJournalFile((uint32_t)snapshotSize, snapshotHash);
+}
+
+// Function to fold the journal into a fresh snapshot and start an empty journal
+OpStatus compactJournal() {
+    if(journal.fd < 0) {
+        return OP_NO_JOURNAL;
+    }
+
+    // 1) the new snapshot replaces the old one first - until then the old pair stays valid
+    journalFlush();
+    size_t size = 0;
+    unsigned char* data = buildSnapshot(&size);
+    OpStatus status = writeFileReplacing(journal.snapshotPath, data, size);
+    uint32_t hash = hashBytes(data, size);
+    free(data);
+    if(status != OP_OK) {
+        return status;
+    }
+
+    // 2) then the journal restarts on it, with the owners numbered as it stores them
+    journalResetIds();
+    status = startJournalFile((uint32_t)size, hash);
+    if(status != OP_OK) {
+        //the old journal no longer matches the snapshot, so nothing more goes into it
+        close(journal.fd);
+        journal.fd = -1;
+    }
+    return status;
+}
+
+// Function to compact the journal from the main menu
+void compactJournalMenu() {
+    OpStatus status = compactJournal();
+    if(status != OP_OK) {
+        printf("%s\n", opStatusMessage(status));
+        return;
+    }
+    printf("Journal compacted into %s.\n", journal.snapshotPath);
+}
+
+// Function to flush and close the journal
+void closeJournal() {
+    journalFlush();
+    if(journal.fd >= 0) {
+        close(journal.fd);
+    }
+    journal.fd = -1;
+    free(journal.snapshotPath);
+    free(journal.journalPath);
+    free(journal.owners);
+    journal.snapshotPath = NULL;
+    journal.journalPath = NULL;
+    journal.owners = NULL;
+    journal.ownerCount = 0;
+    journal.ownerCapacity = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    initNameRanks();
+    initTypeMasks();
+    initSpeciesScores();
+
+    // 1) [--image IMAGE | --journal BASE] [--load SNAPSHOT] [--batch [FILE]]
+    const char* imagePath = NULL;
+    const char* journalBase = NULL;
+    const char* loadPath = NULL;
+    const char* batchPath = NULL;
+    int batch = 0;
+    int usage = 0;
+    for(int i = 1; i < argc && !usage; i++) {
+        if(strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--image") == 0 && i + 1 < argc) {
+            imagePath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journalBase = argv[++i];
+        }
+        else if(strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                batchPath = argv[++i];
+            }
+        }
+        else {
+            usage = 1;
+        }
+    }
+    //image owners change without going through the cores, so they can't be journaled
+    if(usage || (imagePath != NULL && journalBase != NULL)) {
+        printf("Usage: %s [--image IMAGE | --journal BASE] [--load SNAPSHOT] [--batch [FILE]]\n", argv[0]);
+        return 1;
+    }
+
+    // 2) attach the image - batch queries read it in place - or restore the journaled state
+    if(imagePath != NULL) {
+        OpStatus status = mapRegistryImage(imagePath);
+        if(status != OP_OK) {
+            printf("Cannot map %s: %s\n", imagePath, opStatusMessage(status));
+            return 1;
+        }
+    }
+    if(journalBase != NULL) {
+        OpStatus status = openJournal(journalBase);
+        if(status != OP_OK) {
+            printf("Cannot open journal %s: %s\n", journalBase, opStatusMessage(status));
+            return 1;
+        }
+    }
+
+    // 3) add the snapshot, if one was given
+    if(loadPath != NULL) {
+        int owners = 0;
+        OpStatus status = loadSnapshot(loadPath, &owners);
+        if(status != OP_OK) {
+            printf("Cannot load %s: %s\n", loadPath, opStatusMessage(status));
+            return 1;
+        }
+    }
+
+    // 4) --batch runs a command stream (stdin without a file, or with "-") instead of the menus
+    if(batch) {
+        InputReader fileReader = {-1, NULL, 0, 0, 0, 0};
+        InputReader* input = &stdinReader;
+        if(batchPath != NULL && strcmp(batchPath, "-") != 0) {
+            fileReader.fd = open(batchPath, O_RDONLY);
+            if(fileReader.fd < 0) {
+                printf("Cannot open %s.\n", batchPath);
+                freeAllOwners();
+                releaseScratchNodes();
+                closeJournal();
+                return 1;
+            }
+            input = &fileReader;
+        }
+        runBatch(input);
+        if(input == &fileReader) {
+            close(fileReader.fd);
+            releaseInputReader(&fileReader);
+        }
+    }
+    else {
+        //the menus number and walk the list, so everything goes into it
+        materializeImage();
+        mainMenu();
+    }
     freeAllOwners();
+    releaseScratchNodes();
+    releaseInputReader(&stdinReader);
+    unmapRegistryImage();
+    closeJournal();
     return 0;
 }
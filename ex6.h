@@ -1,11 +1,45 @@
 #ifndef EX6_H
 #define EX6_H
 
+// pthreads and sysconf are POSIX; -std=c99 alone hides them
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Pokedex trees are kept height-balanced (AVL) by default.
+// Compile with -DPOKEDEX_BALANCED=0 to get the plain, unbalanced BST back.
+#ifndef POKEDEX_BALANCED
+#define POKEDEX_BALANCED 1
+#endif
+
+// Number of species in pokedex[] (valid IDs are 1..POKEDEX_SIZE)
+#define POKEDEX_SIZE 151
+// 64-bit words needed for one bit per species
+#define POKEDEX_WORDS ((POKEDEX_SIZE + 63) / 64)
+// Number of PokemonType values
+#define TYPE_COUNT 15
+
+// Explicit traversal stacks live on the C stack up to this depth. AVL trees never get
+// that tall; only a degenerate (unbalanced) tree makes a traversal allocate.
+#define TREE_STACK_INLINE 64
+
+// Arena chunks start small (most owners hold a handful of Pokemon) and double up to a cap
+#define ARENA_FIRST_CHUNK 4
+#define ARENA_MAX_CHUNK 64
 
 typedef enum
 {
@@ -45,46 +79,380 @@ typedef struct PokemonData
 // Binary Tree Node (for Pokédex)
 typedef struct PokemonNode
 {
-    PokemonData *data;
+    const PokemonData *data;  // Shared, read-only species record in pokedex[]
     struct PokemonNode *left;
     struct PokemonNode *right;
+    int height;               // Height of the subtree rooted here (a leaf is 1)
+    int size;                 // Number of nodes in the subtree rooted here
+    int heapSlot;             // Index of this Pokemon in the global leaderboard heap, -1 if not in it
 } PokemonNode;
 
+// A contiguous block of node slots, handed out front to back
+typedef struct ArenaChunk
+{
+    struct ArenaChunk *next;
+    int capacity;
+    int used;
+    PokemonNode slots[];
+} ArenaChunk;
+
+// Slab arena for one owner's Pokemon nodes
+typedef struct PokemonArena
+{
+    ArenaChunk *chunks;       // Newest chunk first, new slots are taken from it
+    ArenaChunk *lastChunk;    // Oldest chunk, so another arena can be appended in O(1)
+    PokemonNode *freeList;    // Released slots, linked through left
+    int nextChunkSize;
+} PokemonArena;
+
+// Aggregates of an owner's Pokedex, kept current on every change (never recomputed by traversal)
+typedef struct OwnerStats
+{
+    int pokemonCount;         // Number of set bits in pokedexBits (= nodes in pokedexRoot)
+    unsigned char typeCounts[TYPE_COUNT]; // Pokemon of each PokemonType (at most 151 each)
+    int totalHp;
+    int totalAttack;
+    int evolvableCount;       // Pokemon whose species can still evolve
+    uint64_t scoreRankBits[POKEDEX_WORDS]; // Bit r is set iff the owner has the species of fight-score rank r
+} OwnerStats;
+
 // Linked List Node (for Owners)
 typedef struct OwnerNode
 {
     char *ownerName;          // Owner's name
     PokemonNode *pokedexRoot; // Pointer to the root of the owner's Pokédex
+    PokemonArena arena;       // Where all of the owner's Pokemon nodes live
+    uint64_t pokedexBits[POKEDEX_WORDS]; // Bit (id - 1) is set iff the ID is in pokedexRoot
+    OwnerStats stats;         // Counts, totals and best score of the Pokedex
+    int registrySlot;         // Index of this owner in ownerRegistry.slots
+    int journalId;            // Index of this owner in journal.owners (-1 when not journaled)
     struct OwnerNode *next;   // Next owner in the linked list
     struct OwnerNode *prev;   // Previous owner in the linked list
 } OwnerNode;
 
-// QueueNode Struct (to handle the queue better)
-typedef struct QueueNode {
-    PokemonNode* treeNode;
-    struct QueueNode *next;
-} QueueNode;
-
-// Queue Struct (for BFS)
+// Queue Struct (for BFS) - a growable ring buffer of node pointers
 typedef struct Queue {
-    QueueNode *front;
-    QueueNode *rear;
+    PokemonNode **items;
+    int capacity;             // Always a power of 2
+    int front;                // Index of the first-out element
+    int count;
+    int ownsItems;            // 1 once items was moved to the heap, 0 while it's the caller's buffer
 } Queue;
 
+// Growable array of node pointers, for flattening a Pokedex
+typedef struct
+{
+    PokemonNode **nodes;
+    int size;
+    int capacity;
+} NodeArray;
+
+// Node pointers BFSGeneric keeps on the stack. A balanced tree of all 151 species
+// is at most 76 nodes wide, so the queue never touches the heap unless the tree grows past that.
+#define BFS_STACK_QUEUE 128
+
+// One slot of the owner-name hash index (owner == NULL means empty)
+typedef struct OwnerIndexEntry {
+    uint32_t hash;
+    OwnerNode *owner;
+} OwnerIndexEntry;
+
+// Open-addressing (linear probing) hash table: ownerName -> OwnerNode
+typedef struct OwnerIndex {
+    OwnerIndexEntry *entries;
+    int capacity;             // Always a power of 2 (or 0 before the first insert)
+    int count;
+} OwnerIndex;
+
+// Smallest index table, and the load factor is kept at or below 1/2
+#define OWNER_INDEX_MIN_CAPACITY 16
+
+// Dense, position-indexed view of the owner ring
+typedef struct OwnerRegistry {
+    OwnerNode **slots;        // Owners in ring order starting at ownerHead, NULL where one was removed
+    int *fenwick;             // Fenwick tree over "slot is alive" flags (1-based), for by-position lookups
+    int capacity;
+    int used;                 // Slots handed out so far (alive + removed)
+    int alive;                // Owners currently in the ring
+} OwnerRegistry;
+
+// Pending run slots of the bottom-up owner merge sort (enough for 2^64 owners)
+#define OWNER_SORT_LEVELS 64
+
+// Smallest registry, it doubles (or just compacts) when the slots run out
+#define OWNER_REGISTRY_MIN_CAPACITY 16
+
+// Display rows are formatted into one buffer and handed to write(2) in chunks of this size
+#define OUTPUT_BUFFER_SIZE 65536
+
+// Smallest block the input reader asks read(2) for(it grows for longer lines)
+#define INPUT_BUFFER_SIZE 65536
+
+// Block-buffered line reader over a file descriptor. Lines are handed out as trimmed,
+// NUL-terminated views into data, valid until the next read from the same reader.
+typedef struct InputReader {
+    int fd;
+    char *data;
+    size_t capacity;
+    size_t start;     // first unread byte
+    size_t end;       // one past the last buffered byte
+    int eof;
+} InputReader;
+
+// Output staging buffer used by every display path (see outFlush)
+typedef struct OutputBuffer {
+    char data[OUTPUT_BUFFER_SIZE];
+    int used;
+} OutputBuffer;
+
+// A type name together with its length, so rows can memcpy it
+typedef struct TypeName {
+    const char *name;
+    int length;
+} TypeName;
+
+// A simulated battle that runs this long without a knockout is a tie
+#define BATTLE_MAX_TURNS 100
+// Upper bound on simulation threads
+#define BATTLE_MAX_WORKERS 64
+
+// One battle simulation: every pairing of the participants fights trials times
+typedef struct BattleSimulation {
+    const PokemonData **species;   // Participants
+    int count;
+    unsigned char *pairFirst;      // Pairing p is species[pairFirst[p]] vs species[pairSecond[p]]
+    unsigned char *pairSecond;
+    int pairCount;
+    int trials;                    // Battles per pairing
+    uint64_t seed;
+    int *pairWins;                 // Per pairing: battles won by the first / tied
+    int *pairTies;
+    int workerCount;
+} BattleSimulation;
+
+// A simulation thread: takes every workerCount-th pairing, with its own RNG state
+typedef struct BattleWorker {
+    BattleSimulation *simulation;
+    int index;
+    uint64_t rngState;
+} BattleWorker;
+
+// One Pokemon of one owner in the global leaderboard
+typedef struct LeaderboardEntry {
+    float score;              // speciesScore of node's species, kept here for cache-friendly sifting
+    PokemonNode *node;
+    OwnerNode *owner;
+} LeaderboardEntry;
+
+// Indexed binary max-heap by score over every owned Pokemon (node->heapSlot is the index)
+typedef struct Leaderboard {
+    LeaderboardEntry *entries;
+    int capacity;
+    int count;
+} Leaderboard;
+
+// Top-k queries up to this k keep their candidate heap on the stack
+#define LEADERBOARD_STACK_K 64
+
 // Global head pointer for the linked list of owners
 OwnerNode *ownerHead = NULL;
 
+// Global by-name index of every owner in the list
+OwnerIndex ownerIndex = {NULL, 0, 0};
+
+// Global by-position registry of every owner in the list
+OwnerRegistry ownerRegistry = {NULL, NULL, 0, 0, 0};
+
+// Global fight-score heap of every Pokemon of every owner
+Leaderboard leaderboard = {NULL, 0, 0};
+
+// fightScore of every species (indexed by ID - 1), filled by initSpeciesScores at startup
+float speciesScore[POKEDEX_SIZE];
+// Position of every species by fight score, best first (indexed by ID - 1), and its inverse
+int speciesScoreRank[POKEDEX_SIZE];
+int speciesByScoreRank[POKEDEX_SIZE];
+
+// Keys the owner leaderboard can be sorted by
+typedef enum
+{
+    OWNER_KEY_COUNT,
+    OWNER_KEY_TOTAL_HP,
+    OWNER_KEY_AVERAGE_HP,
+    OWNER_KEY_TOTAL_ATTACK,
+    OWNER_KEY_AVERAGE_ATTACK,
+    OWNER_KEY_MAX_SCORE,
+    OWNER_KEY_EVOLVABLE
+} OwnerStatKey;
+#define OWNER_KEY_TOTAL 7
+
+// Outcome of the silent core operations (the menus and batch mode turn it into messages)
+typedef enum
+{
+    OP_OK,
+    OP_INVALID_ID,
+    OP_INVALID_CHOICE,
+    OP_NAME_TAKEN,
+    OP_NO_OWNER,
+    OP_EMPTY,
+    OP_ALREADY_OWNED,
+    OP_NOT_OWNED,
+    OP_CANNOT_EVOLVE,
+    OP_EVOLUTION_OWNED,  // Evolve found the next form already owned and released the old one
+    OP_SAME_OWNER,
+    OP_BAD_COMMAND,
+    OP_IO_ERROR,
+    OP_BAD_SNAPSHOT,
+    OP_NO_JOURNAL,
+    OP_BAD_JOURNAL
+} OpStatus;
+
+// Most whitespace-separated words one batch command line may have
+#define BATCH_MAX_TOKENS 16
+
+// Snapshot file: header (magic, version, owner count), then the owner-name table
+// (u32 length + bytes each), then one bitset per owner in the same order.
+// Integers are little-endian; bit (id - 1) of a bitset is bit (id - 1) % 8 of byte (id - 1) / 8.
+#define SNAPSHOT_MAGIC "PKDX"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 9
+#define SNAPSHOT_BITSET_BYTES ((POKEDEX_SIZE + 7) / 8)
+
+// Registry image: a file meant to be mmap'd and queried in place. Everything is found by
+// offset, so nothing is parsed at startup. Header (u32 fields, little-endian):
+//   magic, version, owner count, records offset, name index offset, names offset, names size, 0
+// Record (one per owner, fixed size): name offset into the names area, name length,
+//   the owner's SNAPSHOT_BITSET_BYTES bitset, its Pokemon count, zero padding.
+// Name index: u32 record numbers sorted by name (bytewise), for binary search.
+// The species table itself is compiled in (pokedex[]), so records only hold IDs.
+#define IMAGE_MAGIC "PKDI"
+#define IMAGE_VERSION 1
+#define IMAGE_HEADER_SIZE 32
+#define IMAGE_RECORD_SIZE 32
+#define IMAGE_RECORD_BITSET 8
+#define IMAGE_RECORD_COUNT (IMAGE_RECORD_BITSET + SNAPSHOT_BITSET_BYTES)
+
+// A mapped registry image. Owners copied out of it into the list(or deleted) are marked
+// shadowed, and from then on the list's version is the only one.
+typedef struct RegistryImage {
+    const unsigned char *base;   // the mapping (NULL when no image is attached)
+    size_t size;
+    uint32_t ownerCount;
+    const unsigned char *records;
+    const unsigned char *nameIndex;
+    const unsigned char *names;
+    uint32_t namesSize;
+    unsigned char *shadowed;     // one bit per record, allocated on the first write
+    uint32_t shadowedCount;
+} RegistryImage;
+
+// Journal: a 16-byte header (magic, version, size and FNV-1a hash of the snapshot it
+// continues), then fixed-size records of JOURNAL_RECORD_SIZE bytes:
+//   op (1 byte), 0, small argument (u16), owner ID (u32), argument (u32), checksum (u32, FNV-1a of the first 12)
+// Owners are referred to by journal owner ID: the snapshot's owners are 0..n-1 in file order,
+// and every JOURNAL_NEW takes the next one. A new owner's name follows it in JOURNAL_NAME
+// records carrying up to 8 bytes each (in the owner ID and argument fields).
+#define JOURNAL_MAGIC "PKDJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 16
+#define JOURNAL_RECORD_SIZE 16
+#define JOURNAL_NAME_BYTES 8
+// Records kept in memory before they're written and fsync'd(they also go out before
+// every blocking read of input, see nextInputLine)
+#define JOURNAL_BATCH_RECORDS 4096
+
+// Operations a journal record can hold
+typedef enum
+{
+    JOURNAL_NEW = 1,        // small = starter choice, owner = the new ID, argument = name length
+    JOURNAL_NAME,           // small = bytes used, owner/argument = the bytes
+    JOURNAL_ADD,            // argument = Pokemon ID
+    JOURNAL_RELEASE,        // argument = Pokemon ID
+    JOURNAL_RELEASE_RANGE,  // argument = lowest ID, small = highest ID (both clamped to 0..152)
+    JOURNAL_EVOLVE,         // argument = Pokemon ID
+    JOURNAL_MERGE,          // argument = the owner merged in and removed
+    JOURNAL_DELETE,
+    JOURNAL_SORT
+} JournalOp;
+
+// The write-ahead journal. Owners are numbered once snapshotPath is set; records are
+// only written while fd is open(it's -1 during replay)
+typedef struct Journal {
+    char *snapshotPath;
+    char *journalPath;
+    int fd;
+    unsigned char batch[JOURNAL_BATCH_RECORDS * JOURNAL_RECORD_SIZE];
+    int batched;              // records waiting in batch
+    OwnerNode **owners;       // journal owner ID -> owner (NULL once it's gone)
+    uint32_t ownerCount;
+    uint32_t ownerCapacity;
+} Journal;
+
+// Owner name with its record number, for sorting the name index when writing an image
+typedef struct ImageNameEntry {
+    const char *name;
+    uint32_t record;
+} ImageNameEntry;
+
+// One row of the owner leaderboard: the owner and the value it's sorted by
+typedef struct OwnerRankEntry {
+    double key;
+    OwnerNode *owner;
+} OwnerRankEntry;
+
+// Global buffer for display output
+OutputBuffer outputBuffer = {{0}, 0};
+
+// The registry image attached with --image, if any
+RegistryImage registryImage = {NULL, 0, 0, NULL, NULL, NULL, 0, NULL, 0};
+
+// The journal opened with --journal, if any
+Journal journal = {NULL, NULL, -1, {0}, 0, NULL, 0, 0};
+
+// The reader every prompt reads stdin through
+InputReader stdinReader = {STDIN_FILENO, NULL, 0, 0, 0, 0};
+
+// Reusable buffer for flattening Pokedexes (merges), grown on demand and kept until exit
+NodeArray scratchNodes = {NULL, 0, 0};
+
+// Alphabetical position of every species (indexed by ID - 1), filled by initNameRanks at startup
+int speciesNameRank[POKEDEX_SIZE];
+
+// Type names indexed by PokemonType
+static const TypeName typeNames[TYPE_COUNT] = {
+    {"GRASS", 5}, {"FIRE", 4}, {"WATER", 5}, {"BUG", 3}, {"NORMAL", 6},
+    {"POISON", 6}, {"ELECTRIC", 8}, {"GROUND", 6}, {"FAIRY", 5}, {"FIGHTING", 8},
+    {"PSYCHIC", 7}, {"ROCK", 4}, {"GHOST", 5}, {"DRAGON", 6}, {"ICE", 3}
+};
+
+// Attack multiplier of a type (row) against a type (column), in halves: 0 = no effect,
+// 1 = not very effective, 2 = normal, 4 = super effective
+static const unsigned char typeEffectiveness[TYPE_COUNT][TYPE_COUNT] = {
+    //          GRA FIR WAT BUG NOR POI ELE GRO FAI FIG PSY ROC GHO DRA ICE
+    /* GRASS    */ { 1,  1,  4,  1,  2,  1,  2,  4,  2,  2,  2,  4,  2,  1,  2},
+    /* FIRE     */ { 4,  1,  1,  4,  2,  2,  2,  2,  2,  2,  2,  1,  2,  1,  4},
+    /* WATER    */ { 1,  4,  1,  2,  2,  2,  2,  4,  2,  2,  2,  4,  2,  1,  2},
+    /* BUG      */ { 4,  1,  2,  2,  2,  1,  2,  2,  1,  1,  4,  2,  1,  2,  2},
+    /* NORMAL   */ { 2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  1,  0,  2,  2},
+    /* POISON   */ { 4,  2,  2,  2,  2,  1,  2,  1,  4,  2,  2,  1,  1,  2,  2},
+    /* ELECTRIC */ { 1,  2,  4,  2,  2,  2,  1,  0,  2,  2,  2,  2,  2,  1,  2},
+    /* GROUND   */ { 1,  4,  2,  1,  2,  4,  4,  2,  2,  2,  2,  4,  2,  2,  2},
+    /* FAIRY    */ { 2,  1,  2,  2,  2,  1,  2,  2,  2,  4,  2,  2,  2,  4,  2},
+    /* FIGHTING */ { 2,  2,  2,  1,  4,  1,  2,  2,  1,  2,  1,  4,  0,  2,  4},
+    /* PSYCHIC  */ { 2,  2,  2,  2,  2,  4,  2,  2,  2,  4,  1,  2,  2,  2,  2},
+    /* ROCK     */ { 2,  4,  2,  4,  2,  2,  2,  1,  2,  1,  2,  2,  2,  2,  4},
+    /* GHOST    */ { 2,  2,  2,  2,  0,  2,  2,  2,  2,  2,  4,  2,  4,  2,  2},
+    /* DRAGON   */ { 2,  2,  2,  2,  2,  2,  2,  2,  0,  2,  2,  2,  2,  4,  2},
+    /* ICE      */ { 4,  1,  1,  2,  2,  2,  2,  4,  2,  2,  2,  2,  2,  4,  1},
+};
+
+// Species of each type as a Pokedex bitset, filled by initTypeMasks at startup.
+// An owner's Pokemon of a type are pokedexBits & typeSpeciesBits[type].
+uint64_t typeSpeciesBits[TYPE_COUNT][POKEDEX_WORDS];
+
 /* ------------------------------------------------------------
    1) Safe Input + Utility
    ------------------------------------------------------------ */
 
-/**
- * @brief Remove leading/trailing whitespace (including '\r').
- * @param str modifiable string
- * Why we made it: We must handle CR/LF or random spaces in user input.
- */
-void trimWhitespace(char *str);
-
 /**
  * @brief C99-friendly strdup replacement.
  * @param src source string
@@ -102,40 +470,133 @@ char *myStrdup(const char *src);
 int readIntSafe(const char *prompt);
 
 /**
- * @brief Read a line from stdin, store in malloc'd buffer, trim whitespace.
- * @return pointer to the newly allocated string (caller frees)
- * Why we made it: We need flexible name input that handles CR/LF etc.
+ * @brief Get the next line of a reader, trimmed of spaces, tabs and '\r'.
+ * @param reader the reader
+ * @return NUL-terminated view into the reader's buffer (valid until the next call), or NULL at end of input
+ * Why we made it: Scripts of megabytes were read one getchar/fgets at a time; this reads
+ * big blocks with read(2), finds lines with memchr and never copies them.
+ */
+char *nextInputLine(InputReader *reader);
+
+/**
+ * @brief Get the next trimmed line of stdin; at end of input, clean up and exit.
+ * @return view valid until the next read
+ */
+char *readInputLine(void);
+
+/**
+ * @brief Free a reader's buffer.
+ * @param reader the reader
+ */
+void releaseInputReader(InputReader *reader);
+
+/**
+ * @brief Free everything and exit once stdin runs out.
+ * Why we made it: No prompt can be answered anymore, so re-prompting would spin forever.
+ */
+void endOfInput(void);
+
+/**
+ * @brief Write everything in outputBuffer to stdout with write(2) and empty it.
+ * Why we made it: Display paths format rows into one buffer instead of a printf per row.
+ * stdout is flushed first so prompts printed with printf stay in order.
+ */
+void outFlush(void);
+
+/**
+ * @brief Append raw bytes to outputBuffer, flushing it when it is full.
+ * @param text bytes to append
+ * @param length number of bytes
+ */
+void outWrite(const char *text, int length);
+
+/**
+ * @brief Append a NUL-terminated string to outputBuffer.
+ * @param text the string
+ */
+void outString(const char *text);
+
+/**
+ * @brief Append a decimal integer to outputBuffer.
+ * @param value the integer
+ * Why we made it: Formatting digits by hand is much cheaper than a printf conversion.
+ */
+void outInt(int value);
+
+/**
+ * @brief Append numerator / denominator as a decimal with 4 digits after the point.
+ * @param numerator non-negative
+ * @param denominator positive
+ * Why we made it: Probabilities without a printf float conversion.
  */
-char *getDynamicInput(void);
+void outFraction(long numerator, long denominator);
 
 /**
- * @brief Return a string for a given PokemonType enum.
- * @param type the enum
- * @return string like "GRASS", "FIRE", etc.
- * Why we made it: So we can print readable type names.
+ * @brief Append an amount given in hundredths as a decimal with 2 digits after the point.
+ * @param cents non-negative, already rounded to hundredths
+ * Why we made it: Fight scores print with 2 decimals everywhere, as pokemonFight's %.2f does.
  */
-const char *getTypeName(PokemonType type);
+void outCents(long cents);
 
 /* ------------------------------------------------------------
    2) Creating & Freeing Nodes
    ------------------------------------------------------------ */
    
 /**
- * @brief Create a Pokemon data node
- * @param pokedexEntry the Pokemon's PokemonData in the pokedex
- * @return newly allocated PokemonData*
- * Why we made it: We need a way to prepare the matching data pointer for
- * the Pokemon node creation function.
+ * @brief Initialize an empty arena.
+ * @param arena pointer to the arena
+ * Why we made it: Every owner starts with an arena that owns no memory yet.
+ */
+void initPokemonArena(PokemonArena *arena);
+
+/**
+ * @brief Take one node slot from the arena (free list first, then the newest chunk).
+ * @param arena pointer to the arena
+ * @return the node, with its fields uninitialized
+ * Why we made it: Replaces a malloc per Pokemon node.
+ */
+PokemonNode *allocPokemonSlot(PokemonArena *arena);
+
+/**
+ * @brief Give a slot back to its arena's free list.
+ * @param arena pointer to the arena the slot belongs to
+ * @param node the node of the slot
+ * Why we made it: Released Pokemon are recycled by the next add or evolve.
  */
-PokemonData *createPokemonData(const PokemonData pokedexEntry);
+void releasePokemonSlot(PokemonArena *arena, PokemonNode *node);
 
 /**
- * @brief Create a BST node with a copy of the given PokemonData.
- * @param data pointer to PokemonData (like from the global pokedex)
- * @return newly allocated PokemonNode*
+ * @brief Move all chunks and free slots of one arena into another.
+ * @param dest arena that takes ownership
+ * @param src arena that is emptied
+ * Why we made it: Merged Pokemon keep their slots, so the merged-away owner's memory moves too.
+ */
+void adoptPokemonArena(PokemonArena *dest, PokemonArena *src);
+
+/**
+ * @brief Free every chunk of an arena at once.
+ * @param arena pointer to the arena
+ * Why we made it: Deleting an owner costs O(chunks) instead of a walk over every node.
+ */
+void releasePokemonArena(PokemonArena *arena);
+
+/**
+ * @brief Get the shared species record for an ID.
+ * @param id Pokemon ID (1-151)
+ * @return pointer to the immutable pokedex[] entry
+ * Why we made it: Species data never changes per Pokemon, so every node
+ * points at the same record instead of owning a copy of it.
+ */
+const PokemonData *getSpeciesData(int id);
+
+/**
+ * @brief Create a BST node pointing at the species record of the given ID.
+ * @param arena the owner's arena to take the node from
+ * @param id Pokemon ID (1-151)
+ * @return the new PokemonNode*
  * Why we made it: We need a standard way to allocate BST nodes.
  */
-PokemonNode *createPokemonNode(PokemonData *data);
+PokemonNode *createPokemonNode(PokemonArena *arena, int id);
 
 /**
  * @brief Create an OwnerNode for the circular owners list.
@@ -147,28 +608,24 @@ PokemonNode *createPokemonNode(PokemonData *data);
 OwnerNode *createOwner(char *ownerName, PokemonNode *starter);
 
 /**
- * @brief Free a node's Pokemon data
- * @param data a PokemonData pointer which belongs to a PokemonNode
- * Why we made it: Convinient and organized way to free the Pokemon data memory
- */
-void freePokemonData(PokemonData *data);
-
-/**
- * @brief Free one PokemonNode (including name).
+ * @brief Free one PokemonNode back into its arena (the species data is shared and stays).
+ * @param arena the arena the node was taken from
  * @param node pointer to node
  * Why we made it: Avoid memory leaks for single nodes.
  */
-void freePokemonNode(PokemonNode *node);
+void freePokemonNode(PokemonArena *arena, PokemonNode *node);
 
 /**
- * @brief Recursively free a BST of PokemonNodes.
+ * @brief Free a BST of PokemonNodes back into their arena.
+ * @param arena the arena the nodes were taken from
  * @param root BST root
- * Why we made it: Clearing a user’s entire Pokedex means freeing a tree.
+ * Why we made it: Clearing a user’s entire Pokedex means freeing a tree. Done by
+ * rotating the tree into a list as it goes, so it needs no stack whatever the shape.
  */
-void freePokemonTree(PokemonNode *root);
+void freePokemonTree(PokemonArena *arena, PokemonNode *root);
 
 /**
- * @brief Free an OwnerNode (including name and entire Pokedex BST).
+ * @brief Free an OwnerNode (including name and entire Pokedex arena).
  * @param owner pointer to the owner
  * Why we made it: Deleting an owner also frees their Pokedex & name.
  */
@@ -178,6 +635,193 @@ void freeOwnerNode(OwnerNode *owner);
    3) BST Insert, Search, Remove
    ------------------------------------------------------------ */
 
+/**
+ * @brief Get the height of a subtree.
+ * @param node subtree root (may be NULL)
+ * @return the stored height, 0 for an empty subtree
+ * Why we made it: NULL-safe height access for the balancing logic.
+ */
+int getNodeHeight(PokemonNode *node);
+
+/**
+ * @brief Get the number of nodes in a given subtree.
+ * @param node subtree root (may be NULL)
+ * @return stored size, or 0 for an empty subtree
+ */
+int getNodeSize(PokemonNode *node);
+
+/**
+ * @brief Recompute a node's height and subtree size from its children.
+ * @param node pointer to node
+ * Why we made it: Every structural change must keep the stored heights and sizes correct.
+ */
+void updateNodeHeightAndSize(PokemonNode *node);
+
+/**
+ * @brief Get storage for an explicit traversal stack.
+ * @param inlineBuffer caller's buffer of TREE_STACK_INLINE elements
+ * @param depth number of elements needed (the tree height bounds it)
+ * @param elementSize size of one element
+ * @return inlineBuffer if it is big enough, otherwise heap memory
+ * Why we made it: Iterative traversals are bounded by the stored height instead of the call stack.
+ */
+void *allocTreeStack(void *inlineBuffer, int depth, size_t elementSize);
+
+/**
+ * @brief Release a stack from allocTreeStack.
+ * @param stack the stack
+ * @param inlineBuffer the buffer that was passed to allocTreeStack
+ */
+void freeTreeStack(void *stack, void *inlineBuffer);
+
+/**
+ * @brief Rebalance every node along a path of links, from the deepest up to the root.
+ * @param path path[i] is the link (pointer field or root variable) holding the i-th node
+ * @param depth number of links in the path
+ * Why we made it: Iterative insert/remove record their descent, then fix it bottom-up.
+ */
+void rebalancePath(PokemonNode ***path, int depth);
+
+/**
+ * @brief Rotate a subtree to the left (the right child becomes the root).
+ * @param root subtree root
+ * @return the new subtree root
+ * Why we made it: Basic building block of AVL rebalancing.
+ */
+PokemonNode *rotateLeft(PokemonNode *root);
+
+/**
+ * @brief Rotate a subtree to the right (the left child becomes the root).
+ * @param root subtree root
+ * @return the new subtree root
+ * Why we made it: Basic building block of AVL rebalancing.
+ */
+PokemonNode *rotateRight(PokemonNode *root);
+
+/**
+ * @brief Restore the AVL property at a node whose children may differ in height by 2.
+ * @param root subtree root
+ * @return the new subtree root
+ * Why we made it: Sorted inserts (our import scripts) would otherwise turn the tree into a list.
+ */
+PokemonNode *rebalancePokemonNode(PokemonNode *root);
+
+/**
+ * @brief O(1) membership test against an owner's Pokedex bitset.
+ * @param owner pointer to the owner
+ * @param id Pokemon ID (anything outside 1-151 is never owned)
+ * @return 1 if the owner has the Pokemon, 0 otherwise
+ * Why we made it: Existence checks no longer need a tree search.
+ */
+int ownerHasPokemon(const OwnerNode *owner, int id);
+
+/**
+ * @brief Count the Pokemon of an owner.
+ * @param owner pointer to the owner
+ * @return number of Pokemon in the owner's Pokedex
+ * Why we made it: Lets traversal buffers be sized exactly before walking the tree.
+ * It's kept in stats.pokemonCount by setPokemonOwned, so this is O(1).
+ */
+int countOwnedPokemon(const OwnerNode *owner);
+
+/**
+ * @brief Set or clear an ID's bit in an owner's Pokedex bitset.
+ * @param owner pointer to the owner
+ * @param id Pokemon ID (1-151)
+ * @param owned 1 to set the bit, 0 to clear it
+ * Why we made it: Every tree insert/remove keeps the bitset in sync through here.
+ */
+void setPokemonOwned(OwnerNode *owner, int id, int owned);
+
+/**
+ * @brief Add one species to an owner's aggregates.
+ * @param stats the owner's stats
+ * @param id Pokemon ID the owner didn't have
+ * Why we made it: The single place the aggregates grow, used by setPokemonOwned and merges.
+ */
+void statsAddSpecies(OwnerStats *stats, int id);
+
+/**
+ * @brief Remove one species from an owner's aggregates.
+ * @param stats the owner's stats
+ * @param id Pokemon ID the owner had
+ */
+void statsRemoveSpecies(OwnerStats *stats, int id);
+
+/**
+ * @brief The best fight score among an owner's Pokemon.
+ * @param stats the owner's stats
+ * @return the score, or 0 for an empty Pokedex
+ * Why we made it: O(1) - the lowest set bit of scoreRankBits is the best species.
+ */
+float statsMaxScore(const OwnerStats *stats);
+
+/**
+ * @brief The value of one leaderboard key for an owner.
+ * @param stats the owner's stats
+ * @param key which value
+ * @return the value (averages are 0 for an empty Pokedex)
+ */
+double ownerStatValue(const OwnerStats *stats, OwnerStatKey key);
+
+/**
+ * @brief qsort comparator for the owner leaderboard: key descending, then name.
+ * @param a pointer to an OwnerRankEntry
+ * @param b pointer to an OwnerRankEntry
+ * @return negative, 0, or positive
+ */
+int compareOwnerRank(const void *a, const void *b);
+
+/**
+ * @brief Prompt for a key and print all owners with their aggregates, best first.
+ * Why we made it: Reporting reads the cached aggregates instead of walking every tree.
+ */
+void displayOwnerLeaderboard(void);
+
+/**
+ * @brief Get the index of the lowest set bit of a non-zero word.
+ * @param word the word (must not be 0)
+ * @return bit index 0-63
+ * Why we made it: Walking only the set bits of a bitset costs O(matches).
+ */
+int lowestSetBit(uint64_t word);
+
+/**
+ * @brief Fill typeSpeciesBits[] from pokedex[] once.
+ * Why we made it: Species types never change, so a type filter is one AND per word.
+ */
+void initTypeMasks(void);
+
+/**
+ * @brief Print how many Pokemon of each type an owner has.
+ * @param owner pointer to the Owner
+ * Why we made it: Reads the owner's stats.typeCounts, no traversal.
+ */
+void displayTypeHistogram(const OwnerNode *owner);
+
+/**
+ * @brief Print an owner's Pokemon of one type, by ID.
+ * @param owner pointer to the Owner
+ * @param type the type to show
+ * Why we made it: Walks the set bits of pokedexBits & typeSpeciesBits[type], O(matches).
+ */
+void displayPokemonOfType(const OwnerNode *owner, PokemonType type);
+
+/**
+ * @brief Menu for the per-type histogram and type filter.
+ * @param owner pointer to the Owner
+ */
+void pokedexTypeMenu(OwnerNode *owner);
+
+/**
+ * @brief Build a perfectly balanced tree from nodes sorted by ID.
+ * @param nodes array of node pointers, sorted by ID (their links are overwritten)
+ * @param count number of nodes
+ * @return root of the new tree
+ * Why we made it: Rebuilding after a merge is O(n) and as shallow as a tree can get.
+ */
+PokemonNode *buildBalancedTree(PokemonNode **nodes, int count);
+
 /**
  * @brief Find the minimum element of the tree based on ID.
  * @param root PokemonNode pointer type BST.
@@ -204,31 +848,60 @@ PokemonNode *insertPokemonNode(PokemonNode *root, PokemonNode *newNode);
  */
 PokemonNode *searchPokemonBFS(PokemonNode *root, int id);
 
-/**
- * @brief Searches for the node to replace a given node to remove.
- * @param root Pokemon node pointer which we'd like to remove from the Pokedex tree.
- * @return The node were are searching for.
- * Why we made it:
- */
-PokemonNode* findNodeReplacementBST(PokemonNode* root);
-
 /**
  * @brief Remove node from BST by ID if found (BST removal logic).
+ * @param arena the arena the removed node goes back to
  * @param root BST root
  * @param id ID to remove
  * @return updated BST root
  * Why we made it: We handle special cases of a BST remove (0,1,2 children).
  */
-PokemonNode *removeNodeBST(PokemonNode *root, int id);
+PokemonNode *removeNodeBST(PokemonArena *arena, PokemonNode *root, int id);
 
 /**
  * @brief Combine BFS search + BST removal to remove Pokemon by ID.
+ * @param arena the arena the removed node goes back to
  * @param root BST root
  * @param id ID to remove
  * @return updated BST root
  * Why we made it: BFS confirms existence, then removeNodeBST does the removal.
  */
-PokemonNode *removePokemonByID(PokemonNode *root, int id);
+PokemonNode *removePokemonByID(PokemonArena *arena, PokemonNode *root, int id);
+
+/**
+ * @brief Join two BSTs around a middle node: every ID in left < mid < every ID in right.
+ * @param left left BST (may be NULL)
+ * @param mid detached node that goes between them
+ * @param right right BST (may be NULL)
+ * @return root of the joined (balanced) BST
+ * Why we made it: Walks down the taller tree's spine only as far as the heights differ, O(log n),
+ * along a path stack like insert and remove.
+ */
+PokemonNode *joinPokemonTrees(PokemonNode *left, PokemonNode *mid, PokemonNode *right);
+
+/**
+ * @brief Split a BST into the IDs lower than a given ID and the rest.
+ * @param root BST root (consumed)
+ * @param id split point
+ * @param lower output: BST of IDs < id
+ * @param rest output: BST of IDs >= id
+ * Why we made it: Cuts a whole ID range out of a tree with O(log n) joins instead of per-node removals;
+ * the walk down is kept on an explicit stack, so unbalanced trees don't deepen the call stack.
+ */
+void splitPokemonTree(PokemonNode *root, int id, PokemonNode **lower, PokemonNode **rest);
+
+/**
+ * @brief Remove every Pokemon with an ID in [low, high] from a BST, without printing.
+ * @param arena the arena the removed nodes go back to
+ * @param root BST root
+ * @param low lowest ID
+ * @param high highest ID
+ * @param removedCount output: how many nodes were removed
+ * @return updated BST root
+ * Why we made it: Two splits cut out the range as one subtree, which is freed whole, and one join
+ * puts the two sides back together.
+ */
+PokemonNode *removePokemonRange(PokemonArena *arena, PokemonNode *root, int low, int high, int *removedCount);
 
 /* ------------------------------------------------------------
    4) Generic BST Traversals (Function Pointers)
@@ -263,6 +936,23 @@ void preOrderGeneric(PokemonNode *root, VisitNodeFunc visit);
  */
 void inOrderGeneric(PokemonNode *root, VisitNodeFunc visit);
 
+/**
+ * @brief In-order traversal of only the nodes with an ID in [low, high].
+ * @param root BST root
+ * @param low lowest ID
+ * @param high highest ID
+ * @param visit function pointer
+ * Why we made it: Subtrees entirely outside the range are never entered, and the walk
+ * stops at the first ID past high.
+ */
+void rangeGeneric(PokemonNode *root, int low, int high, VisitNodeFunc visit);
+
+/**
+ * @brief Prompt for an ID range and print the Pokemon in it, by ID.
+ * @param root BST root
+ */
+void displayRange(PokemonNode *root);
+
 /**
  * @brief A generic post-order traversal (Left-Right-Root).
  * @param root BST root
@@ -275,28 +965,21 @@ void postOrderGeneric(PokemonNode *root, VisitNodeFunc visit);
  * @brief Print one PokemonNode’s data: ID, Name, Type, HP, Attack, Evolve?
  * @param node pointer to the node
  * Why we made it: We can pass this to BFSGeneric or others to quickly print.
+ * The row goes into outputBuffer; the display function that walks the tree flushes it.
  */
 void printPokemonNode(PokemonNode *node);
 
+/**
+ * @brief Print one species' row, formatted like printPokemonNode.
+ * @param data the species record
+ * Why we made it: Bitset-driven displays have species, not tree nodes.
+ */
+void printSpeciesRow(const PokemonData *data);
+
 /* ------------------------------------------------------------
    5) Display Methods (BFS, Pre, In, Post, Alphabetical)
    ------------------------------------------------------------ */
 
-typedef struct
-{
-    PokemonNode **nodes;
-    int size;
-    int capacity;
-} NodeArray;
-
-/**
- * @brief Initialize a NodeArray with given capacity.
- * @param na pointer to NodeArray
- * @param cap initial capacity
- * Why we made it: We store pointers to PokemonNodes for alphabetical sorting.
- */
-void initNodeArray(NodeArray *na, int cap);
-
 /**
  * @brief Add a PokemonNode pointer to NodeArray, realloc if needed.
  * @param na pointer to NodeArray
@@ -306,33 +989,86 @@ void initNodeArray(NodeArray *na, int cap);
 void addNode(NodeArray *na, PokemonNode *node);
 
 /**
- * @brief Recursively collect all nodes from the BST into a NodeArray.
+ * @brief Make sure a NodeArray can hold at least cap nodes, keeping its contents.
+ * @param na pointer to NodeArray
+ * @param cap required capacity
+ * Why we made it: Callers that know the exact count size the array once instead of growing it.
+ */
+void reserveNodeArray(NodeArray *na, int cap);
+
+/**
+ * @brief Free the shared scratch NodeArray.
+ * Why we made it: scratchNodes lives across menu operations, so it's released once at exit.
+ */
+void releaseScratchNodes(void);
+
+/**
+ * @brief Collect all nodes from the BST into a NodeArray (pre-order).
  * @param root BST root
  * @param na pointer to NodeArray
- * Why we made it: We gather everything for qsort.
+ * Why we made it: A flat copy of a whole Pokedex when the order doesn't matter.
  */
 void collectAll(PokemonNode *root, NodeArray *na);
 
 /**
- * @brief Compare function for qsort (alphabetical by node->data->name).
- * @param a pointer to a pointer to PokemonNode
- * @param b pointer to a pointer to PokemonNode
- * @return -1, 0, or +1
- * Why we made it: Sorting by name for alphabetical display.
+ * @brief Collect all nodes from the BST into a NodeArray in ID order.
+ * @param root BST root
+ * @param na pointer to NodeArray
+ * Why we made it: Sorted arrays of both Pokedexes make merging a single linear pass.
+ */
+void flattenInOrder(PokemonNode *root, NodeArray *na);
+
+/**
+ * @brief Compare function for qsort (alphabetical by species name, then by ID).
+ * @param a pointer to a pointer to a pokedex[] entry
+ * @param b pointer to a pointer to a pokedex[] entry
+ * @return negative, 0, or positive
+ * Why we made it: Orders the species once when building the name-rank table.
+ */
+int compareSpeciesByName(const void *a, const void *b);
+
+/**
+ * @brief Fill speciesNameRank[] by sorting pokedex[] by name once.
+ * Why we made it: Names never change, so alphabetical order can be looked up instead of compared.
+ */
+void initNameRanks(void);
+
+/**
+ * @brief Place every node of the BST in the slot of its species' name rank.
+ * @param root BST root
+ * @param byRank POKEDEX_SIZE slots, NULL where the species isn't in the tree
+ * Why we made it: A bucket pass over ranks replaces sorting for the alphabetical display.
  */
-int compareByNameNode(const void *a, const void *b);
+void scatterByNameRank(PokemonNode *root, PokemonNode **byRank);
 
 /**
- * @brief BFS is nice, but alphabetical means we gather all nodes, sort by name, then print.
+ * @brief Print all Pokemon sorted by name.
  * @param root BST root
  * Why we made it: Provide user the option to see Pokemon sorted by name.
+ * Nodes are bucketed by name rank and printed in rank order, without comparing strings.
  */
 void displayAlphabetical(PokemonNode *root);
 
+/**
+ * @brief Set up an empty queue on top of a caller-provided buffer.
+ * @param queue the queue
+ * @param buffer initial storage (typically a stack array)
+ * @param capacity number of pointers in buffer, a power of 2
+ * Why we made it: Level-order traversal of small trees shouldn't allocate at all.
+ */
+void initQueue(Queue *queue, PokemonNode **buffer, int capacity);
+
+/**
+ * @brief Free the queue's storage if it had to grow onto the heap.
+ * @param queue the queue
+ */
+void freeQueue(Queue *queue);
+
 /**
  * @brief Simple enqueue function to push a node to a given queue
  * @param queue a queue of Pokemon nodes used to handle BFS visit order
  * @param node a node to be pushed into the queue
+ * Doubles the ring buffer when it is full - no allocation per node.
  */
 void enqueue(Queue* queue, PokemonNode *node);
 
@@ -376,64 +1112,286 @@ void postOrderTraversal(PokemonNode *root);
    ------------------------------------------------------------ */
 
 /**
- * @brief Let user pick two Pokemon by ID in the same Pokedex to fight.
- * @param owner pointer to the Owner
- * Why we made it: Fun demonstration of BFS and custom formula for battles.
+ * @brief Count the Pokemon in a BST with an ID lower than a given one.
+ * @param root BST root
+ * @param id the ID (doesn't have to be in the tree)
+ * @return number of smaller IDs
+ * Why we made it: One root-to-leaf walk over subtree sizes, the base of rank and range queries.
  */
-void pokemonFight(OwnerNode *owner);
+int countPokemonBelow(PokemonNode *root, int id);
 
 /**
- * @brief Evolve a Pokemon (ID -> ID+1) if allowed.
- * @param owner pointer to the Owner
- * Why we made it: Demonstrates removing an old ID, inserting the next ID.
+ * @brief Find the position of an ID in a BST's ID order.
+ * @param root BST root
+ * @param id the ID to look for
+ * @return 1-based rank, or 0 if the ID isn't in the tree
  */
-void evolvePokemon(OwnerNode *owner);
+int rankOfPokemon(PokemonNode *root, int id);
 
 /**
- * @brief Prompt for an ID, BFS-check duplicates, then insert into BST.
- * @param owner pointer to the Owner
- * Why we made it: Primary user function for adding new Pokemon to an owner’s Pokedex.
+ * @brief Find the k-th lowest ID in a BST.
+ * @param root BST root
+ * @param k 1-based position
+ * @return the node, or NULL if k is out of [1, size]
+ * Why we made it: Subtree sizes tell which side the k-th node is on, O(log n).
  */
-void addPokemon(OwnerNode *owner);
+PokemonNode *selectPokemonByRank(PokemonNode *root, int k);
 
 /**
- * @brief Prompt for ID, remove that Pokemon from BST by ID.
+ * @brief Count the Pokemon in a BST with an ID in [low, high].
+ * @param root BST root
+ * @param low lowest ID
+ * @param high highest ID
+ * @return number of IDs in the range (0 if low > high)
+ */
+int countPokemonInRange(PokemonNode *root, int low, int high);
+
+/**
+ * @brief Menu for the range count, k-th lowest ID and rank queries on an owner's Pokedex.
  * @param owner pointer to the Owner
- * Why we made it: Another user function for releasing a Pokemon.
  */
-void freePokemon(OwnerNode *owner);
+void pokedexQueryMenu(OwnerNode *owner);
 
-/* ------------------------------------------------------------
-   7) Display Menu for a Pokedex
-   ------------------------------------------------------------ */
+/**
+ * @brief The battle score of a species: attack * 1.5 + hp * 1.2.
+ * @param data the species record
+ * @return the score
+ * Why we made it: pokemonFight and the fight-everyone modes must score exactly alike.
+ */
+float fightScore(const PokemonData *data);
 
 /**
- * @brief Show sub-menu to let user pick BFS, Pre, In, Post, or alphabetical.
- * @param owner pointer to Owner
- * Why we made it: We want a simple menu that picks from various traversals.
+ * @brief Append an owner's species in ID order to a participant list.
+ * @param owner pointer to the Owner
+ * @param species output array (room for owner->stats.pokemonCount more entries)
+ * @param start index to write the first one at
+ * @return index after the last one written
+ * Why we made it: Walks the set bits of pokedexBits, no tree traversal.
  */
-void displayMenu(OwnerNode *owner);
+int collectFightParticipants(const OwnerNode *owner, const PokemonData **species, int start);
 
-/* ------------------------------------------------------------
-   8) Sorting Owners (Bubble Sort on Circular List)
-   ------------------------------------------------------------ */
+/**
+ * @brief Score every participant into a contiguous float array.
+ * @param species participants
+ * @param scores output, one per participant
+ * @param count number of participants
+ * Why we made it: The counting passes want the scores in one flat array; they come straight
+ * from speciesScore[], so nothing is recomputed or allocated per call.
+ */
+void computeFightScores(const PokemonData **species, float *scores, int count);
 
 /**
- * @brief helper function to swap the data of two nodes in the linked list
- * @param owner1 owner node pointer
- * @param owner2 owner node pointer
+ * @brief Count how many participants each one beats and ties with.
+ * @param scores scores of the participants
+ * @param count number of participants
+ * @param wins output: participants with a strictly lower score
+ * @param ties output: other participants with an equal score
+ * Why we made it: One sort plus two binary searches per participant, O(n log n) instead of n^2 fights.
  */
-void swapOwnerNodesData(OwnerNode* owner1, OwnerNode* owner2);
+void countFightOutcomes(const float *scores, int count, int *wins, int *ties);
 
 /**
- * @brief Sort the circular owners list by name.
- * Why we made it: Another demonstration of pointer manipulation + sorting logic.
+ * @brief qsort comparator for floats (ascending).
+ * @param a pointer to a float
+ * @param b pointer to a float
+ * @return negative, 0, or positive
  */
-void sortOwners(void);
+int compareFloats(const void *a, const void *b);
 
 /**
- * @brief Helper to swap name & pokedexRoot in two OwnerNode.
- * @param a pointer to first owner
+ * @brief Print one participant's fight totals into outputBuffer.
+ * @param owner owner to label the row with, or NULL for none
+ * @param data the species
+ * @param wins fights won
+ * @param ties fights tied
+ * @param losses fights lost
+ */
+void printFightRow(const OwnerNode *owner, const PokemonData *data, int wins, int ties, int losses);
+
+/**
+ * @brief Every Pokemon of an owner fights every other: prints the matrix or the win counts.
+ * @param owner pointer to the Owner
+ */
+void fightEveryoneMenu(OwnerNode *owner);
+
+/**
+ * @brief Every Pokemon of every owner fights every other, prints per-Pokemon win counts.
+ * Why we made it: Balance analysis across the whole population.
+ */
+void fightAllOwners(void);
+
+/**
+ * @brief splitmix64: advance a 64-bit state and return the next random number.
+ * @param state the generator state
+ * @return 64 random bits
+ * Why we made it: Tiny, fast and seedable from any value, so every pairing gets its own stream.
+ */
+uint64_t nextRandom(uint64_t *state);
+
+/**
+ * @brief Simulate one multi-turn battle between two species.
+ * @param first first species
+ * @param second second species
+ * @param rngState the caller's generator state
+ * @return 1 if first wins, -1 if second wins, 0 on a tie (BATTLE_MAX_TURNS without a knockout)
+ * Why we made it: A random first mover and damage rolls scaled by typeEffectiveness
+ * make the outcome a probability instead of a fixed comparison.
+ */
+int simulateBattle(const PokemonData *first, const PokemonData *second, uint64_t *rngState);
+
+/**
+ * @brief Thread entry: run the trials of every pairing assigned to one worker.
+ * @param arg pointer to a BattleWorker
+ * @return NULL
+ */
+void *battleWorkerMain(void *arg);
+
+/**
+ * @brief Run a whole simulation over simulation->workerCount threads.
+ * @param simulation filled in except for the results
+ * Why we made it: Pairings are independent, so threads share nothing but read-only input.
+ * Each pairing reseeds from (seed, pairing), so results don't depend on the thread count.
+ */
+void runBattleSimulation(BattleSimulation *simulation);
+
+/**
+ * @brief Number of online CPUs (at least 1, at most BATTLE_MAX_WORKERS).
+ * @return default worker count
+ */
+int defaultWorkerCount(void);
+
+/**
+ * @brief Prompt for trials, threads and seed, simulate all pairings of an owner's Pokemon
+ * and print each one's win and tie probabilities.
+ * @param owner pointer to the Owner
+ */
+void battleSimulationMenu(OwnerNode *owner);
+
+/**
+ * @brief Let user pick two Pokemon by ID in the same Pokedex to fight.
+ * @param owner pointer to the Owner
+ * Why we made it: Fun demonstration of BFS and custom formula for battles.
+ */
+void pokemonFight(OwnerNode *owner);
+
+/**
+ * @brief Print the two fighters with their scores and the outcome.
+ * @param first the first species
+ * @param second the second species
+ */
+void printFightResult(const PokemonData *first, const PokemonData *second);
+
+/**
+ * @brief Evolve a Pokemon (ID -> ID+1) if allowed.
+ * @param owner pointer to the Owner
+ * Why we made it: Demonstrates swapping an old ID for the next one (the node just
+ * points at the next species record, its place in the tree stays valid).
+ */
+void evolvePokemon(OwnerNode *owner);
+
+/**
+ * @brief Evolve a Pokemon without printing anything.
+ * @param owner pointer to the Owner
+ * @param id Pokemon ID to evolve
+ * @return OP_OK, OP_EVOLUTION_OWNED (the old form was released instead), OP_EMPTY,
+ * OP_NOT_OWNED or OP_CANNOT_EVOLVE
+ * Why we made it: Shared by the menu and batch mode, which print different things.
+ */
+OpStatus evolvePokemonCore(OwnerNode *owner, int id);
+
+/**
+ * @brief Prompt for an ID, BFS-check duplicates, then insert into BST.
+ * @param owner pointer to the Owner
+ * Why we made it: Primary user function for adding new Pokemon to an owner’s Pokedex.
+ */
+void addPokemon(OwnerNode *owner);
+
+/**
+ * @brief Insert a Pokemon into an owner's Pokedex without printing anything.
+ * @param owner pointer to the Owner
+ * @param id Pokemon ID to add
+ * @return OP_OK, OP_INVALID_ID or OP_ALREADY_OWNED
+ */
+OpStatus addPokemonCore(OwnerNode *owner, int id);
+
+/**
+ * @brief Prompt for ID, remove that Pokemon from BST by ID.
+ * @param owner pointer to the Owner
+ * Why we made it: Another user function for releasing a Pokemon.
+ */
+void freePokemon(OwnerNode *owner);
+
+/**
+ * @brief Release a Pokemon from an owner's Pokedex without printing anything.
+ * @param owner pointer to the Owner
+ * @param id Pokemon ID to release
+ * @return OP_OK, OP_EMPTY or OP_NOT_OWNED
+ */
+OpStatus releasePokemonCore(OwnerNode *owner, int id);
+
+/**
+ * @brief Prompt for an ID range and release every Pokemon in it at once.
+ * @param owner pointer to the Owner
+ * Why we made it: Cleaning up hundreds of IDs shouldn't re-descend the tree once per ID.
+ */
+void freePokemonRange(OwnerNode *owner);
+
+/**
+ * @brief Release every Pokemon in an ID range without printing anything.
+ * @param owner pointer to the Owner
+ * @param low lowest ID
+ * @param high highest ID
+ * @return number of Pokemon released
+ */
+int releasePokemonRangeCore(OwnerNode *owner, int low, int high);
+
+/* ------------------------------------------------------------
+   7) Display Menu for a Pokedex
+   ------------------------------------------------------------ */
+
+/**
+ * @brief Show sub-menu to let user pick BFS, Pre, In, Post, or alphabetical.
+ * @param owner pointer to Owner
+ * Why we made it: We want a simple menu that picks from various traversals.
+ */
+void displayMenu(OwnerNode *owner);
+
+/* ------------------------------------------------------------
+   8) Sorting Owners (Merge Sort on Circular List)
+   ------------------------------------------------------------ */
+
+/**
+ * @brief Merge two NULL-terminated (next-linked) owner lists sorted by name.
+ * @param a first sorted list, wins ties so the sort stays stable
+ * @param b second sorted list
+ * @return head of the merged list (prev pointers are left for the caller)
+ * Why we made it: The merge step of the owner merge sort, done by relinking nodes.
+ */
+OwnerNode *mergeOwnerLists(OwnerNode *a, OwnerNode *b);
+
+/**
+ * @brief Merge sort a NULL-terminated (next-linked) owner list by name.
+ * @param head first node
+ * @return head of the sorted list
+ * Why we made it: O(n log n) compares and no per-node data swapping.
+ */
+OwnerNode *mergeSortOwnerList(OwnerNode *head);
+
+/**
+ * @brief Sort the circular owners list by name.
+ * Why we made it: Another demonstration of pointer manipulation + sorting logic -
+ * break the ring, merge sort the nodes, then close the ring again.
+ */
+void sortOwners(void);
+
+/**
+ * @brief Sort the owners by name without printing anything (no-op for 0 or 1 owners).
+ */
+void sortOwnersCore(void);
+
+/**
+ * @brief Helper to swap name & pokedexRoot in two OwnerNode.
+ * @param a pointer to first owner
  * @param b pointer to second owner
  * Why we made it: Used internally by bubble sort to swap data.
  */
@@ -457,22 +1415,211 @@ void linkOwnerInCircularList(OwnerNode *newOwner);
  */
 void removeOwnerFromCircularList(OwnerNode **target);
 
+/**
+ * @brief FNV-1a hash of an owner name.
+ * @param name the name
+ * @return 32-bit hash
+ * Why we made it: Key function of the owner-name index.
+ */
+uint32_t hashOwnerName(const char *name);
+
+/**
+ * @brief Put an entry in the first empty slot of its probe sequence.
+ * @param entries the slot array
+ * @param capacity its size (power of 2)
+ * @param entry the entry to place
+ * Why we made it: Shared by insertion and by re-placing everything on growth.
+ */
+void ownerIndexPlace(OwnerIndexEntry *entries, int capacity, OwnerIndexEntry entry);
+
+/**
+ * @brief Add an owner to the by-name index (grows the table when half full).
+ * @param owner pointer to the owner
+ * Why we made it: Called whenever an owner joins the list.
+ */
+void ownerIndexInsert(OwnerNode *owner);
+
+/**
+ * @brief Remove an owner from the by-name index.
+ * @param owner pointer to the owner (looked up by its current name)
+ * Why we made it: Called whenever an owner leaves the list or changes its name.
+ */
+void ownerIndexRemove(OwnerNode *owner);
+
+/**
+ * @brief Drop every entry and free the index table.
+ * Why we made it: Program cleanup, together with freeAllOwners.
+ */
+void ownerIndexClear(void);
+
 /**
  * @brief Find an owner by name in the circular list.
  * @param name string to match
  * @return pointer to the matching OwnerNode or NULL
- * Why we made it: We often need to locate an owner quickly.
+ * Why we made it: We often need to locate an owner quickly - a hash lookup is O(1) expected.
  */
 OwnerNode *findOwnerByName(const char *name);
 
+/**
+ * @brief Add 'delta' to slot i (0-based) of the registry's Fenwick tree.
+ * @param slot slot index
+ * @param delta +1 when a slot becomes alive, -1 when it is removed
+ * Why we made it: Keeps prefix counts of alive owners in O(log n).
+ */
+void registryFenwickAdd(int slot, int delta);
+
+/**
+ * @brief Re-pack the registry from the ring, dropping removed slots.
+ * @param capacity slot capacity of the rebuilt registry
+ * Why we made it: Growth, compaction and reordering (sorting) all rebuild in O(n).
+ */
+void registryRebuild(int capacity);
+
+/**
+ * @brief Append an owner at the end of the registry (the ring's tail).
+ * @param owner pointer to the owner
+ * Why we made it: Called whenever an owner joins the ring.
+ */
+void registryAppend(OwnerNode *owner);
+
+/**
+ * @brief Mark an owner's slot as removed.
+ * @param owner pointer to the owner
+ * Why we made it: Called whenever an owner leaves the ring.
+ */
+void registryRemove(OwnerNode *owner);
+
+/**
+ * @brief Free the registry.
+ * Why we made it: Program cleanup, together with freeAllOwners.
+ */
+void registryClear(void);
+
 /**
  * @brief Find an owner based on the number of steps to reach them starting from the head node.
  * @param numberOfSteps Integer representing the number of steps we want to take to reach the owner.
  * @return ownerNode pointer to the owner we've searched for.
  * Why we made it: An organized way to locate an owner after they're displayed in the menu.
+ * The registry answers it in O(log n) without walking the ring.
  */
 OwnerNode* findOwnerByPosition(int numberOfSteps);
 
+/* ------------------------------------------------------------
+   Global Leaderboard
+   ------------------------------------------------------------ */
+
+/**
+ * @brief Fill speciesScore[] with fightScore of every species once, and rank the species by it.
+ * Why we made it: The score only depends on the species, so the heap never recomputes it,
+ * and an owner's best score is the lowest set bit of its stats.scoreRankBits.
+ */
+void initSpeciesScores(void);
+
+/**
+ * @brief Heap order: higher score first, then lower ID.
+ * @param a first entry
+ * @param b second entry
+ * @return 1 if a belongs above b
+ */
+int leaderboardAbove(const LeaderboardEntry *a, const LeaderboardEntry *b);
+
+/**
+ * @brief Move the entry at a slot up or down until the heap order holds again.
+ * @param slot index of the entry
+ * Why we made it: Shared by insert, remove and update; keeps every node->heapSlot current.
+ */
+void leaderboardSift(int slot);
+
+/**
+ * @brief Move the entry at a slot down until neither child beats it.
+ * @param slot index of the entry
+ */
+void leaderboardSiftDown(int slot);
+
+/**
+ * @brief Add an owner's new Pokemon to the leaderboard.
+ * @param owner the owner
+ * @param node the node (its heap slot is set here; it may go into the owner's tree before or after)
+ */
+void leaderboardInsert(OwnerNode *owner, PokemonNode *node);
+
+/**
+ * @brief Add a Pokemon at the end of the leaderboard without restoring the heap order.
+ * @param owner the owner
+ * @param node the node
+ * Why we made it: Bulk loads append everything and call leaderboardHeapify once.
+ */
+void leaderboardAppend(OwnerNode *owner, PokemonNode *node);
+
+/**
+ * @brief Restore the heap order of the whole leaderboard bottom-up, O(n).
+ */
+void leaderboardHeapify(void);
+
+/**
+ * @brief Take a Pokemon out of the leaderboard (no-op if it isn't in it).
+ * @param node the node
+ * Why we made it: Called from freePokemonNode, so every way of releasing a Pokemon is covered.
+ */
+void leaderboardRemove(PokemonNode *node);
+
+/**
+ * @brief Re-score a Pokemon whose species changed (evolution).
+ * @param node the node
+ */
+void leaderboardUpdate(PokemonNode *node);
+
+/**
+ * @brief Record that a Pokemon now belongs to another owner (merge, owner data swap).
+ * @param node the node
+ * @param owner the new owner
+ */
+void leaderboardSetOwner(PokemonNode *node, OwnerNode *owner);
+
+/**
+ * @brief Free the leaderboard.
+ * Why we made it: Program cleanup, together with freeAllOwners.
+ */
+void leaderboardClear(void);
+
+/**
+ * @brief Push a leaderboard index onto a candidate heap (same order as the leaderboard).
+ * @param heap the candidate heap
+ * @param count its size, incremented
+ * @param value leaderboard index
+ */
+void candidateHeapPush(int *heap, int *count, int value);
+
+/**
+ * @brief Pop the best leaderboard index off a candidate heap.
+ * @param heap the candidate heap (not empty)
+ * @param count its size, decremented
+ * @return the best index
+ */
+int candidateHeapPop(int *heap, int *count);
+
+/**
+ * @brief Find the k best entries of the leaderboard, best first.
+ * @param k how many
+ * @param result output: up to k entry indexes
+ * @return number found (min(k, Pokemon in the heap))
+ * Why we made it: A small candidate heap walks the big one from the top, O(k log k) and
+ * independent of how many Pokemon there are.
+ */
+int leaderboardTopK(int k, int *result);
+
+/**
+ * @brief Prompt for k and print the k strongest Pokemon of all owners.
+ * Why we made it: "Strongest Pokemon anywhere" without visiting every tree.
+ */
+void displayTopPokemon(void);
+
+/**
+ * @brief Print the k strongest Pokemon of all owners.
+ * @param k how many (clamped to the number of Pokemon)
+ */
+void printTopPokemon(int k);
+
 /* ------------------------------------------------------------
    10) Owner Menus
    ------------------------------------------------------------ */
@@ -489,6 +1636,14 @@ void enterExistingPokedexMenu(void);
  */
 void openPokedexMenu(void);
 
+/**
+ * @brief Create an owner with a starter and link it into the list, without printing anything.
+ * @param ownerName malloc'd name, owned by the new owner on OP_OK (the caller keeps it otherwise)
+ * @param starterChoice 1 = Bulbasaur, 2 = Charmander, 3 = Squirtle
+ * @return OP_OK, OP_NAME_TAKEN or OP_INVALID_CHOICE
+ */
+OpStatus openPokedexCore(char *ownerName, int starterChoice);
+
 /**
  * @brief Delete an entire Pokedex (owner) from the list.
  * Why we made it: Let user pick which Pokedex to remove and free everything.
@@ -499,6 +1654,7 @@ void deletePokedex(void);
  * @brief Merge an owner's Pokedex into the other's.
  * @param owner1 the owner to merge into.
  * @param owner2 the owner to merge from and delete afterwards.
+ * Why we made it: Sorted flatten + linear merge + balanced rebuild is O(n + m).
  */
 void mergePokedexes(OwnerNode* owner1, OwnerNode* owner2);
 
@@ -508,6 +1664,20 @@ void mergePokedexes(OwnerNode* owner1, OwnerNode* owner2);
  */
 void mergePokedexMenu(void);
 
+/**
+ * @brief Merge the second owner into the first and remove the second, without printing anything.
+ * @param owner1 the owner to merge into
+ * @param owner2 the owner to merge from (freed on OP_OK)
+ * @return OP_OK or OP_SAME_OWNER
+ */
+OpStatus mergeOwnersCore(OwnerNode *owner1, OwnerNode *owner2);
+
+/**
+ * @brief Remove an owner and everything it has, without printing anything.
+ * @param owner the owner (freed)
+ */
+void deleteOwnerCore(OwnerNode *owner);
+
 /* ------------------------------------------------------------
    11) Printing Owners in a Circle
    ------------------------------------------------------------ */
@@ -525,6 +1695,13 @@ int checkDirection(char* direction);
  */
 void printOwnersCircular(void);
 
+/**
+ * @brief Print one "[index] name" row of printOwnersCircular into outputBuffer.
+ * @param index row number
+ * @param owner owner to print
+ */
+void printOwnerRow(int index, const OwnerNode *owner);
+
 /**
  * @brief Print all owners in the list.
  * Why we made it: A simple way to print all of them without dealing with circular repetition.
@@ -551,6 +1728,379 @@ void freeAllOwners(void);
  */
 void mainMenu(void);
 
+/* ------------------------------------------------------------
+   14) Batch Mode
+   ------------------------------------------------------------ */
+
+/**
+ * @brief The message a batch error line shows for a status.
+ * @param status a failed OpStatus
+ * @return constant string
+ */
+const char *opStatusMessage(OpStatus status);
+
+/**
+ * @brief Split a line into whitespace-separated words, in place.
+ * @param line the line (modified)
+ * @param tokens output array of BATCH_MAX_TOKENS word pointers
+ * @return number of words, or -1 if there are more than BATCH_MAX_TOKENS
+ */
+int splitBatchTokens(char *line, char **tokens);
+
+/**
+ * @brief Parse a whole word as an int.
+ * @param token the word
+ * @param value output
+ * @return 1 on success, 0 if the word isn't a number
+ */
+int parseBatchInt(const char *token, int *value);
+
+/**
+ * @brief Run one batch command.
+ * @param tokens the command's words (tokens[0] is the command)
+ * @param count number of words
+ * @return OP_OK (or OP_EVOLUTION_OWNED) on success, the reason otherwise
+ */
+OpStatus runBatchCommand(char **tokens, int count);
+
+/**
+ * @brief Run a command stream, one command per line, printing only results and errors.
+ * @param input reader over the stream
+ * Why we made it: Scripted workloads through mainMenu spend most of their time re-printing
+ * menus and prompts; this calls the core operations directly and reports commands/sec.
+ */
+void runBatch(InputReader *input);
+
+/* ------------------------------------------------------------
+   15) Snapshots
+   ------------------------------------------------------------ */
+
+/**
+ * @brief Store a 32-bit value little-endian.
+ * @param out 4 bytes
+ * @param value the value
+ */
+void putUint32(unsigned char *out, uint32_t value);
+
+/**
+ * @brief Load a little-endian 32-bit value.
+ * @param in 4 bytes
+ * @return the value
+ */
+uint32_t getUint32(const unsigned char *in);
+
+/**
+ * @brief Write all owners to a snapshot file (through a temporary file, renamed over it).
+ * @param path file to write
+ * @param savedCount output: owners written
+ * @return OP_OK or OP_IO_ERROR
+ * Why we made it: Everything in the ring used to be lost at exit; 19 bytes per owner
+ * (plus the name) keeps it.
+ */
+OpStatus saveSnapshot(const char *path, int *savedCount);
+
+/**
+ * @brief Encode every owner in the list as a snapshot.
+ * @param size output: number of bytes
+ * @return malloc'd snapshot bytes (caller frees)
+ */
+unsigned char *buildSnapshot(size_t *size);
+
+/**
+ * @brief Write a buffer to a file through a temporary file renamed over it.
+ * @param path file to write
+ * @param data bytes
+ * @param size number of bytes
+ * @return OP_OK or OP_IO_ERROR (the old file is kept on failure)
+ */
+OpStatus writeFileReplacing(const char *path, const unsigned char *data, size_t size);
+
+/**
+ * @brief fsync the directory holding a file, so a rename into it survives a power loss.
+ * @param path the file
+ * @return OP_OK or OP_IO_ERROR
+ * Why we made it: Compaction replaces the snapshot and then the journal; the second rename
+ * must never reach the disk without the first.
+ */
+OpStatus syncParentDirectory(const char *path);
+
+/**
+ * @brief Read a whole file into memory.
+ * @param path file to read
+ * @param size output: its size
+ * @return malloc'd bytes (caller frees), or NULL if it can't be read
+ */
+unsigned char *readWholeFile(const char *path, size_t *size);
+
+/**
+ * @brief Create an owner from a snapshot bitset, its tree built balanced from the sorted IDs.
+ * @param ownerName malloc'd name, owned by the new owner
+ * @param bitset SNAPSHOT_BITSET_BYTES bytes
+ * @return the new owner (not linked into the list yet; its Pokemon are appended to the
+ * leaderboard, so call leaderboardHeapify before using it)
+ * Why we made it: The bitset walk already yields IDs in order, so the tree is built bottom-up
+ * with no insertPokemonNode descent per ID.
+ */
+OwnerNode *restoreOwner(char *ownerName, const unsigned char *bitset);
+
+/**
+ * @brief Add every owner of a snapshot file to the list (all or nothing).
+ * @param path file to read
+ * @param loadedCount output: owners added
+ * @return OP_OK, OP_IO_ERROR, OP_BAD_SNAPSHOT, or OP_NAME_TAKEN if an owner already exists
+ */
+OpStatus loadSnapshot(const char *path, int *loadedCount);
+
+/**
+ * @brief Prompt for a file name and save or load a snapshot.
+ * @param save 1 to save, 0 to load
+ */
+void snapshotMenu(int save);
+
+/* ------------------------------------------------------------
+   16) Registry Image
+   ------------------------------------------------------------ */
+
+/**
+ * @brief Map a registry image read-only and attach it.
+ * @param path image file
+ * @return OP_OK, OP_IO_ERROR, or OP_BAD_SNAPSHOT if the header or the areas don't fit the file
+ * Why we made it: Reporting jobs over a million owners start in milliseconds - only the
+ * header is checked, the records are read in place when a query touches them.
+ */
+OpStatus mapRegistryImage(const char *path);
+
+/**
+ * @brief Unmap the attached image, if any.
+ */
+void unmapRegistryImage(void);
+
+/**
+ * @brief The name of an image record.
+ * @param record record number
+ * @param length output: name length
+ * @return pointer into the mapping (not NUL-terminated), or NULL if the record's name is out of bounds
+ */
+const char *imageOwnerName(uint32_t record, uint32_t *length);
+
+/**
+ * @brief Find an owner in the attached image by binary search over the name index.
+ * @param name NUL-terminated name
+ * @return record number, or -1 if it isn't there (or was shadowed)
+ */
+long imageFindOwner(const char *name);
+
+/**
+ * @brief Whether a record has been copied out or deleted.
+ * @param record record number
+ * @return 1 if shadowed
+ */
+int imageIsShadowed(uint32_t record);
+
+/**
+ * @brief Mark a record as copied out or deleted.
+ * @param record record number
+ */
+void imageShadow(uint32_t record);
+
+/**
+ * @brief Expand an image record's bitset into pokedexBits layout.
+ * @param record record number
+ * @param bits output words
+ */
+void imageOwnerBits(uint32_t record, uint64_t bits[POKEDEX_WORDS]);
+
+/**
+ * @brief Copy an image record's bitset, dropping IDs past POKEDEX_SIZE.
+ * @param record record number
+ * @param bitset output, SNAPSHOT_BITSET_BYTES bytes
+ */
+void imageRecordBitset(uint32_t record, unsigned char bitset[SNAPSHOT_BITSET_BYTES]);
+
+/**
+ * @brief Copy an image record's name into malloc'd memory.
+ * @param record record number (its name must be in bounds)
+ * @return NUL-terminated copy (caller owns it)
+ */
+char *imageNameCopy(uint32_t record);
+
+/**
+ * @brief Whether a name is used by an owner in the list or in the image.
+ * @param name the name
+ * @return 1 if taken
+ */
+int ownerNameTaken(const char *name);
+
+/**
+ * @brief Copy one image owner into the list (copy-on-write before a change).
+ * @param record an unshadowed record
+ * @return the new owner
+ */
+OwnerNode *materializeImageOwner(uint32_t record);
+
+/**
+ * @brief Copy every remaining image owner into the list.
+ * Why we made it: The menus, the global leaderboard and saving work on the list only.
+ */
+void materializeImage(void);
+
+/**
+ * @brief Find an owner to change: from the list, or copied out of the image.
+ * @param name the name
+ * @return the owner, or NULL if there's none
+ */
+OwnerNode *findOwnerForUpdate(const char *name);
+
+/**
+ * @brief Get an owner's Pokedex bits from the list or straight from the image.
+ * @param name the name
+ * @param bits output words
+ * @return OP_OK or OP_NO_OWNER
+ * Why we made it: show/find/fight only need the ID set, so image owners are never copied for them.
+ */
+OpStatus readOwnerBits(const char *name, uint64_t bits[POKEDEX_WORDS]);
+
+/**
+ * @brief qsort comparator for ImageNameEntry (bytewise by name).
+ * @param a pointer to an ImageNameEntry
+ * @param b pointer to an ImageNameEntry
+ * @return negative, 0, or positive
+ */
+int compareImageNames(const void *a, const void *b);
+
+/**
+ * @brief Write every owner (the image's included) as a registry image.
+ * @param path file to write
+ * @param writtenCount output: owners written
+ * @return OP_OK or OP_IO_ERROR
+ */
+OpStatus writeRegistryImage(const char *path, int *writtenCount);
+
+/* ------------------------------------------------------------
+   17) Journal
+   ------------------------------------------------------------ */
+
+/**
+ * @brief FNV-1a hash of a byte range.
+ * @param data the bytes
+ * @param size number of bytes
+ * @return the hash
+ */
+uint32_t hashBytes(const unsigned char *data, size_t size);
+
+/**
+ * @brief Give an owner the next journal owner ID.
+ * @param owner the owner
+ */
+void journalAssignId(OwnerNode *owner);
+
+/**
+ * @brief Number the owners 0..n-1 in list order, as the snapshot that was just written has them.
+ */
+void journalResetIds(void);
+
+/**
+ * @brief Queue one record; a full batch is written and fsync'd.
+ * @param op the operation
+ * @param small the u16 argument
+ * @param owner the owner's journal ID
+ * @param argument the u32 argument
+ * Why we made it: Every core operation logs itself here, so the menus and batch mode are covered alike.
+ */
+void journalAppend(JournalOp op, uint16_t small, uint32_t owner, uint32_t argument);
+
+/**
+ * @brief Log a change to an owner (no-op when the journal isn't open for writing).
+ * @param op the operation
+ * @param owner the owner
+ * @param small the u16 argument
+ * @param argument the u32 argument
+ */
+void journalOwnerOp(JournalOp op, const OwnerNode *owner, uint16_t small, uint32_t argument);
+
+/**
+ * @brief Number a new owner and log its creation with its name.
+ * @param owner the new owner (already in the list)
+ * @param starterChoice the starter it was created with
+ */
+void journalNewOwner(OwnerNode *owner, int starterChoice);
+
+/**
+ * @brief Write and fsync the batched records.
+ * Why we made it: One fsync per batch instead of per operation; a crash loses at most the
+ * records still in the batch.
+ */
+void journalFlush(void);
+
+/**
+ * @brief Apply one journal operation through the core operations.
+ * @param record the operation's first record
+ * @param available bytes of checksummed records from record on (enough for a new owner's name)
+ * @return bytes the operation took (a new owner takes its name records too), or 0 if it
+ * doesn't apply to the current owners
+ */
+size_t replayJournalRecord(const unsigned char *record, size_t available);
+
+/**
+ * @brief Check a journal record's checksum (and its always-zero byte).
+ * @param record JOURNAL_RECORD_SIZE bytes
+ * @return 1 if intact, 0 if not
+ */
+int journalRecordIntact(const unsigned char *record);
+
+/**
+ * @brief Apply journal records on top of the loaded snapshot, calling the core operations directly.
+ * @param data the records (after the header)
+ * @param size number of bytes
+ * @param applied output: bytes of records applied
+ * @return OP_OK if it stopped at the end or at a torn tail (everything after *applied), or
+ * OP_BAD_JOURNAL if an intact record doesn't apply or intact records follow the damage by more
+ * than one batch (nothing is applied in that case)
+ * Why we made it: Replaying thousands of operations shouldn't go through menus, prompts or printing.
+ */
+OpStatus replayJournal(const unsigned char *data, size_t size, size_t *applied);
+
+/**
+ * @brief Write a journal file holding only the header for the given snapshot bytes, and open it for appending.
+ * @param snapshotSize size of the snapshot
+ * @param snapshotHash hashBytes of the snapshot
+ * @return OP_OK or OP_IO_ERROR
+ */
+OpStatus startJournalFile(uint32_t snapshotSize, uint32_t snapshotHash);
+
+/**
+ * @brief Join a path prefix and a suffix.
+ * @param base path prefix
+ * @param suffix the suffix
+ * @return malloc'd path
+ */
+char *journalFilePath(const char *base, const char *suffix);
+
+/**
+ * @brief Load BASE.snap, replay BASE.journal on top of it and keep journaling to it.
+ * @param base path prefix
+ * @return OP_OK, OP_IO_ERROR, OP_BAD_SNAPSHOT, or OP_BAD_JOURNAL (the journal is left as it is)
+ */
+OpStatus openJournal(const char *base);
+
+/**
+ * @brief Fold the journal into a fresh snapshot and start an empty journal.
+ * @return OP_OK or OP_IO_ERROR
+ * Why we made it: Keeps replay short; a crash in between leaves a journal whose header
+ * doesn't match the new snapshot, so it's never applied twice.
+ */
+OpStatus compactJournal(void);
+
+/**
+ * @brief Compact the journal and report it (main menu 13).
+ */
+void compactJournalMenu(void);
+
+/**
+ * @brief Flush and close the journal.
+ */
+void closeJournal(void);
+
 // Array of Pokemon data
 static const PokemonData pokedex[] = {
     {1, "Bulbasaur", GRASS, 45, 49, CAN_EVOLVE},